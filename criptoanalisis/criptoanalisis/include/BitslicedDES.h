@@ -0,0 +1,450 @@
+#pragma once
+#include "Prerequisites.h"
+#include "DES.h"
+#include <utility>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @struct BitSlice
+ * @brief One bit position of 64 * Lanes independent DES blocks packed into machine words.
+ *
+ * Bit l of lane w holds the value of that bit position for block 64 * w + l.
+ * The generic version is a plain array of uint64_t so the compiler can vectorize
+ * the boolean operators; an AVX2 specialization is provided for 4 lanes.
+ */
+template<size_t Lanes>
+struct
+BitSlice {
+  uint64_t lane[Lanes];
+
+  static BitSlice
+  zero() {
+    BitSlice s;
+    for (size_t i = 0; i < Lanes; ++i) s.lane[i] = 0;
+    return s;
+  }
+
+  static BitSlice
+  ones() {
+    BitSlice s;
+    for (size_t i = 0; i < Lanes; ++i) s.lane[i] = ~0ULL;
+    return s;
+  }
+
+  uint64_t
+  get(size_t i) const {
+    return lane[i];
+  }
+
+  void
+  set(size_t i, uint64_t value) {
+    lane[i] = value;
+  }
+
+  friend BitSlice
+  operator&(const BitSlice& a, const BitSlice& b) {
+    BitSlice r;
+    for (size_t i = 0; i < Lanes; ++i) r.lane[i] = a.lane[i] & b.lane[i];
+    return r;
+  }
+
+  friend BitSlice
+  operator|(const BitSlice& a, const BitSlice& b) {
+    BitSlice r;
+    for (size_t i = 0; i < Lanes; ++i) r.lane[i] = a.lane[i] | b.lane[i];
+    return r;
+  }
+
+  friend BitSlice
+  operator^(const BitSlice& a, const BitSlice& b) {
+    BitSlice r;
+    for (size_t i = 0; i < Lanes; ++i) r.lane[i] = a.lane[i] ^ b.lane[i];
+    return r;
+  }
+
+  friend BitSlice
+  operator~(const BitSlice& a) {
+    BitSlice r;
+    for (size_t i = 0; i < Lanes; ++i) r.lane[i] = ~a.lane[i];
+    return r;
+  }
+
+  BitSlice& operator&=(const BitSlice& o) { return *this = *this & o; }
+  BitSlice& operator|=(const BitSlice& o) { return *this = *this | o; }
+  BitSlice& operator^=(const BitSlice& o) { return *this = *this ^ o; }
+};
+
+#if defined(__AVX2__)
+/**
+ * @brief AVX2 specialization: 256 blocks per slice in a single ymm register.
+ */
+template<>
+struct
+BitSlice<4> {
+  __m256i v;
+
+  static BitSlice
+  zero() {
+    return { _mm256_setzero_si256() };
+  }
+
+  static BitSlice
+  ones() {
+    return { _mm256_set1_epi64x(-1) };
+  }
+
+  uint64_t
+  get(size_t i) const {
+    alignas(32) uint64_t tmp[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(tmp), v);
+    return tmp[i];
+  }
+
+  void
+  set(size_t i, uint64_t value) {
+    alignas(32) uint64_t tmp[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(tmp), v);
+    tmp[i] = value;
+    v = _mm256_load_si256(reinterpret_cast<const __m256i*>(tmp));
+  }
+
+  friend BitSlice operator&(const BitSlice& a, const BitSlice& b) { return { _mm256_and_si256(a.v, b.v) }; }
+  friend BitSlice operator|(const BitSlice& a, const BitSlice& b) { return { _mm256_or_si256(a.v, b.v) }; }
+  friend BitSlice operator^(const BitSlice& a, const BitSlice& b) { return { _mm256_xor_si256(a.v, b.v) }; }
+  friend BitSlice operator~(const BitSlice& a) { return { _mm256_xor_si256(a.v, _mm256_set1_epi64x(-1)) }; }
+
+  BitSlice& operator&=(const BitSlice& o) { return *this = *this & o; }
+  BitSlice& operator|=(const BitSlice& o) { return *this = *this | o; }
+  BitSlice& operator^=(const BitSlice& o) { return *this = *this ^ o; }
+};
+#endif
+
+/**
+ * @class BitslicedDES
+ * @brief Bitsliced backend for the DES class: encrypts 64 * Lanes blocks per call.
+ *
+ * Each of the 64 bit positions of a block is stored in its own BitSlice, so the
+ * Feistel network runs as plain boolean operations over all blocks at once.
+ * Expansion and P permutation become free index remapping, and the S-box is
+ * evaluated as a sum of minterms derived from DES::SBOX at compile time.
+ * The output is bit-for-bit identical to DES::encode / DES::decode.
+ *
+ * Every lane may also carry its own key (see setKeys), which is what the key
+ * search engines use.
+ */
+template<size_t Lanes>
+class
+BitslicedDES {
+public:
+  using Slice = BitSlice<Lanes>;
+
+  /// Number of blocks processed per call.
+  static constexpr size_t BLOCKS = 64 * Lanes;
+
+  /**
+   * @brief Default constructor (all-zero key).
+   */
+  BitslicedDES() {
+    for (auto& s : m_key) s = Slice::zero();
+  }
+
+  /**
+   * @brief Constructs the engine with the same 64-bit key in every lane.
+   * @param key The 64-bit key as a std::bitset, same format as DES::DES.
+   */
+  BitslicedDES(const std::bitset<64>& key) {
+    setKey(key);
+  }
+
+  ~BitslicedDES() = default;
+
+  /**
+   * @brief Broadcasts one 64-bit key to every lane.
+   * @param key The 64-bit key.
+   */
+  void
+  setKey(const std::bitset<64>& key) {
+    uint64_t k = key.to_ullong();
+    for (int b = 0; b < 64; ++b) {
+      m_key[b] = ((k >> b) & 1) ? Slice::ones() : Slice::zero();
+    }
+  }
+
+  /**
+   * @brief Loads a different key into each lane.
+   * @param keys Array of keys; block i is processed with keys[i].
+   * @param count Number of keys (at most BLOCKS); missing lanes get key 0.
+   */
+  void
+  setKeys(const uint64_t* keys, size_t count) {
+    loadSlices(keys, count, m_key);
+  }
+
+  /**
+   * @brief Encrypts up to BLOCKS 64-bit blocks.
+   * @param in Input blocks, in the numeric format of std::bitset<64>::to_ullong().
+   * @param out Output blocks (may alias @p in).
+   * @param count Number of blocks (at most BLOCKS).
+   */
+  void
+  encode(const uint64_t* in, uint64_t* out, size_t count) const {
+    Slice s[64];
+    loadSlices(in, count, s);
+    encodeSlices(s);
+    storeSlices(s, out, count);
+  }
+
+  /**
+   * @brief Decrypts up to BLOCKS 64-bit blocks.
+   * @param in Input blocks.
+   * @param out Output blocks (may alias @p in).
+   * @param count Number of blocks (at most BLOCKS).
+   */
+  void
+  decode(const uint64_t* in, uint64_t* out, size_t count) const {
+    Slice s[64];
+    loadSlices(in, count, s);
+    decodeSlices(s);
+    storeSlices(s, out, count);
+  }
+
+  /**
+   * @brief Runs the encryption rounds directly on bitsliced data.
+   * @tparam Rounds Number of rounds (16 for DES, fewer for reduced-round analysis).
+   * @param s The 64 bit slices; slice b holds bit b of every block.
+   */
+  template<int Rounds = 16>
+  void
+  encodeSlices(Slice (&s)[64]) const {
+    runRounds<Rounds>(s, false);
+  }
+
+  /**
+   * @brief Runs the decryption rounds directly on bitsliced data.
+   * @tparam Rounds Number of rounds.
+   * @param s The 64 bit slices; slice b holds bit b of every block.
+   */
+  template<int Rounds = 16>
+  void
+  decodeSlices(Slice (&s)[64]) const {
+    runRounds<Rounds>(s, true);
+  }
+
+  /**
+   * @brief Transposes up to BLOCKS words into 64 bit slices.
+   * @param in Input words.
+   * @param count Number of words; the remaining lanes are zero-filled.
+   * @param s Output slices.
+   */
+  static void
+  loadSlices(const uint64_t* in, size_t count, Slice (&s)[64]) {
+    uint64_t tmp[64];
+    for (size_t w = 0; w < Lanes; ++w) {
+      for (size_t i = 0; i < 64; ++i) {
+        size_t idx = w * 64 + i;
+        tmp[i] = idx < count ? in[idx] : 0;
+      }
+      transpose64(tmp);
+      for (int b = 0; b < 64; ++b) {
+        s[b].set(w, tmp[63 - b]);
+      }
+    }
+  }
+
+  /**
+   * @brief Transposes 64 bit slices back into up to BLOCKS words.
+   * @param s Input slices.
+   * @param out Output words.
+   * @param count Number of words to write.
+   */
+  static void
+  storeSlices(const Slice (&s)[64], uint64_t* out, size_t count) {
+    uint64_t tmp[64];
+    for (size_t w = 0; w < Lanes && w * 64 < count; ++w) {
+      for (int b = 0; b < 64; ++b) {
+        tmp[63 - b] = s[b].get(w);
+      }
+      transpose64(tmp);
+      for (size_t i = 0; i < 64 && w * 64 + i < count; ++i) {
+        out[w * 64 + i] = tmp[i];
+      }
+    }
+  }
+
+  /**
+   * @brief Maps a bit of a slice word back to the block it belongs to.
+   * @param word Lane (64-bit word) index inside the slice.
+   * @param bit Bit position inside that word.
+   * @return Index of the block in the arrays given to loadSlices.
+   */
+  static size_t
+  blockOfBit(size_t word, int bit) {
+    return word * 64 + (63 - bit);
+  }
+
+private:
+  /**
+   * @brief In-place 64x64 bit matrix transpose (Hacker's Delight, 7-3).
+   *
+   * After the call, bit (63 - c) of a[r] holds what was bit (63 - r) of a[c].
+   */
+  static void
+  transpose64(uint64_t (&a)[64]) {
+    uint64_t m = 0x00000000FFFFFFFFULL;
+    for (int j = 32; j != 0; j >>= 1, m ^= (m << j)) {
+      for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+        uint64_t t = (a[k] ^ (a[k | j] >> j)) & m;
+        a[k] ^= t;
+        a[k | j] ^= (t << j);
+      }
+    }
+  }
+
+  /**
+   * @brief Truth tables of the four S-box output bits over the 6-bit input.
+   *
+   * Input bit t of index v is bit 6k + t of the box input, exactly as
+   * DES::substitute reads it (row = b0 b5, column = b1 b2 b3 b4).
+   */
+  static constexpr std::array<uint64_t, 4>
+  buildTruthTables() {
+    std::array<uint64_t, 4> t{};
+    for (int v = 0; v < 64; ++v) {
+      int row = ((v & 1) << 1) | ((v >> 5) & 1);
+      int col = (((v >> 1) & 1) << 3) | (((v >> 2) & 1) << 2) |
+        (((v >> 3) & 1) << 1) | ((v >> 4) & 1);
+      int value = DES::SBOX[row][col];
+      for (int j = 0; j < 4; ++j) {
+        if ((value >> (3 - j)) & 1) {
+          t[j] |= 1ULL << v;
+        }
+      }
+    }
+    return t;
+  }
+
+  static constexpr std::array<uint64_t, 4> SBOX_TRUTH = buildTruthTables();
+
+  /**
+   * @brief Builds the 8 minterms of three slices; index bit t selects x_t or ~x_t.
+   */
+  static void
+  minterms(const Slice& x0, const Slice& x1, const Slice& x2, Slice (&m)[8]) {
+    Slice n0 = ~x0, n1 = ~x1, n2 = ~x2;
+    Slice p[4] = { n0 & n1, x0 & n1, n0 & x1, x0 & x1 };
+    for (int a = 0; a < 4; ++a) {
+      m[a] = p[a] & n2;
+      m[a + 4] = p[a] & x2;
+    }
+  }
+
+  /**
+   * @brief ORs minterm @p m into @p acc when output bit J is set for input V.
+   *
+   * Resolved at compile time, so the S-box circuit has no runtime branches.
+   */
+  template<int J, int V>
+  static void
+  accumulate(Slice& acc, const Slice& m) {
+    if constexpr (((SBOX_TRUTH[J] >> V) & 1) != 0) {
+      acc |= m;
+    }
+  }
+
+  /**
+   * @brief Adds the contribution of high minterm C to the four output slices.
+   */
+  template<int C, int... A>
+  static void
+  sboxColumn(const Slice (&lo)[8], const Slice& hi, Slice* out,
+             std::integer_sequence<int, A...>) {
+    Slice acc[4] = { Slice::zero(), Slice::zero(), Slice::zero(), Slice::zero() };
+    (accumulate<0, A | (C << 3)>(acc[0], lo[A]), ...);
+    (accumulate<1, A | (C << 3)>(acc[1], lo[A]), ...);
+    (accumulate<2, A | (C << 3)>(acc[2], lo[A]), ...);
+    (accumulate<3, A | (C << 3)>(acc[3], lo[A]), ...);
+    for (int j = 0; j < 4; ++j) {
+      out[j] |= acc[j] & hi;
+    }
+  }
+
+  template<int... C>
+  static void
+  sboxColumns(const Slice (&lo)[8], const Slice (&hi)[8], Slice* out,
+              std::integer_sequence<int, C...>) {
+    (sboxColumn<C>(lo, hi[C], out, std::make_integer_sequence<int, 8>{}), ...);
+  }
+
+  /**
+   * @brief Bitsliced S-box: 6 input slices to 4 output slices.
+   */
+  static void
+  sbox(const Slice* in, Slice* out) {
+    Slice lo[8], hi[8];
+    minterms(in[0], in[1], in[2], lo);
+    minterms(in[3], in[4], in[5], hi);
+
+    for (int j = 0; j < 4; ++j) out[j] = Slice::zero();
+    sboxColumns(lo, hi, out, std::make_integer_sequence<int, 8>{});
+  }
+
+  /**
+   * @brief The Feistel network over bit slices.
+   * @tparam Rounds Number of rounds (1-16).
+   * @param s Slices of the blocks; updated in place.
+   * @param decrypt Whether to apply the subkeys in reverse order.
+   */
+  template<int Rounds>
+  void
+  runRounds(Slice (&s)[64], bool decrypt) const {
+    static_assert(Rounds >= 1 && Rounds <= 16, "DES has between 1 and 16 rounds");
+    Slice left[32], right[32];
+    for (int b = 0; b < 32; ++b) {
+      right[b] = s[b];
+      left[b] = s[32 + b];
+    }
+
+    for (int r = 0; r < Rounds; ++r) {
+      int round = decrypt ? Rounds - 1 - r : r;
+
+      // Expansion + subkey mix: subkey bit i of round n is key bit i + n
+      Slice x[48];
+      for (int i = 0; i < 48; ++i) {
+        x[i] = right[32 - DES::EXPANSION_TABLE[i]] ^ m_key[i + round];
+      }
+
+      Slice sub[32];
+      for (int k = 0; k < 8; ++k) {
+        sbox(&x[k * 6], &sub[k * 4]);
+      }
+
+      for (int i = 0; i < 32; ++i) {
+        Slice newRight = left[i] ^ sub[32 - DES::P_TABLE[i]];
+        left[i] = right[i];
+        right[i] = newRight;
+      }
+    }
+
+    for (int b = 0; b < 32; ++b) {
+      s[b] = left[b];
+      s[32 + b] = right[b];
+    }
+  }
+
+  Slice m_key[64]; ///< Key bit slices; slice b holds bit b of each lane's key.
+};
+
+/// 64 blocks per call on any 64-bit target.
+using BitslicedDES64 = BitslicedDES<1>;
+
+#if defined(__AVX2__)
+/// 256 blocks per call using AVX2 registers.
+using BitslicedDES256 = BitslicedDES<4>;
+/// Widest bitsliced engine available in this build.
+using BitslicedDESNative = BitslicedDES256;
+#else
+/// Widest bitsliced engine available in this build.
+using BitslicedDESNative = BitslicedDES64;
+#endif
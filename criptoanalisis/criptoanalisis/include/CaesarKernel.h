@@ -0,0 +1,139 @@
+#pragma once
+#include "Prerequisites.h"
+#include "XORKernel.h"
+
+/**
+ * @class CaesarKernel
+ * @brief Vectorized Caesar shift of letters and digits, without a branch per byte.
+ *
+ * Letters move within a-z and A-Z and digits within 0-9; every other byte is
+ * copied unchanged. Any integer shift is accepted: it is reduced mod 26 for
+ * letters and mod 10 for digits, so negative shifts undo positive ones.
+ *
+ * The SIMD paths classify 16 or 32 bytes at once with signed compares (all
+ * the affected bytes are below 0x80) and add a per-byte delta: the shift, or
+ * the shift minus the alphabet size where it wraps. table() gives the same
+ * mapping as a 256-byte lookup table, used for the tail and as the scalar
+ * backend. The CPU backend is the one XORKernel detects.
+ */
+class
+CaesarKernel {
+public:
+  /**
+   * @brief Shifts @p size bytes of @p in into @p out.
+   * @param in Input bytes.
+   * @param out Output bytes; may be the same pointer as @p in (in place).
+   * @param size Number of bytes.
+   * @param shift Shift (any integer; negative shifts decrypt).
+   */
+  static void
+  apply(const unsigned char* in, unsigned char* out, size_t size, int shift) {
+    if (size == 0) return;
+    int letters = normalize(shift, 26);
+    int digits = normalize(shift, 10);
+    size_t i = 0;
+
+    switch (XORKernel::backend()) {
+#if defined(XOR_KERNEL_X86)
+    case XORKernel::Backend::AVX2:
+      i = applyAVX2(in, out, size, letters, digits);
+      break;
+    case XORKernel::Backend::SSE2:
+      i = applySSE2(in, out, size, letters, digits);
+      break;
+#endif
+    default:
+      break;
+    }
+
+    if (i < size) {
+      const std::array<unsigned char, 256> lut = table(shift);
+      for (; i < size; ++i) {
+        out[i] = lut[in[i]];
+      }
+    }
+  }
+
+  /**
+   * @brief Lookup table of the shift: output byte of every input byte.
+   * @param shift Shift (any integer).
+   */
+  static std::array<unsigned char, 256>
+  table(int shift) {
+    int letters = normalize(shift, 26);
+    int digits = normalize(shift, 10);
+    std::array<unsigned char, 256> lut;
+    for (int c = 0; c < 256; ++c) {
+      lut[c] = static_cast<unsigned char>(c);
+    }
+    for (int i = 0; i < 26; ++i) {
+      lut['a' + i] = static_cast<unsigned char>('a' + (i + letters) % 26);
+      lut['A' + i] = static_cast<unsigned char>('A' + (i + letters) % 26);
+    }
+    for (int i = 0; i < 10; ++i) {
+      lut['0' + i] = static_cast<unsigned char>('0' + (i + digits) % 10);
+    }
+    return lut;
+  }
+
+private:
+  /**
+   * @brief @p shift reduced to [0, @p n).
+   */
+  static int
+  normalize(int shift, int n) {
+    return ((shift % n) + n) % n;
+  }
+
+#if defined(XOR_KERNEL_X86)
+  /**
+   * @brief Delta for the bytes of @p x in [first, first + n): s, or s - n where x + s wraps.
+   */
+  static __m128i
+  delta(__m128i x, char first, int n, int s) {
+    __m128i in = _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(static_cast<char>(first - 1))),
+                               _mm_cmplt_epi8(x, _mm_set1_epi8(static_cast<char>(first + n))));
+    __m128i wrap = _mm_cmpgt_epi8(x, _mm_set1_epi8(static_cast<char>(first + n - 1 - s)));
+    __m128i d = _mm_sub_epi8(_mm_set1_epi8(static_cast<char>(s)),
+                             _mm_and_si128(wrap, _mm_set1_epi8(static_cast<char>(n))));
+    return _mm_and_si128(in, d);
+  }
+
+  /**
+   * @brief Shifts the 16-byte blocks; returns the bytes done.
+   */
+  static size_t
+  applySSE2(const unsigned char* in, unsigned char* out, size_t size, int letters, int digits) {
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+      __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+      __m128i d = _mm_or_si128(_mm_or_si128(delta(x, 'a', 26, letters), delta(x, 'A', 26, letters)),
+                               delta(x, '0', 10, digits));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi8(x, d));
+    }
+    return i;
+  }
+
+  XOR_KERNEL_AVX2 static __m256i
+  delta256(__m256i x, char first, int n, int s) {
+    __m256i in = _mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8(static_cast<char>(first - 1))),
+                                  _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(first + n)), x));
+    __m256i wrap = _mm256_cmpgt_epi8(x, _mm256_set1_epi8(static_cast<char>(first + n - 1 - s)));
+    __m256i d = _mm256_sub_epi8(_mm256_set1_epi8(static_cast<char>(s)),
+                                _mm256_and_si256(wrap, _mm256_set1_epi8(static_cast<char>(n))));
+    return _mm256_and_si256(in, d);
+  }
+
+  XOR_KERNEL_AVX2 static size_t
+  applyAVX2(const unsigned char* in, unsigned char* out, size_t size, int letters, int digits) {
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+      __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+      __m256i d = _mm256_or_si256(_mm256_or_si256(delta256(x, 'a', 26, letters), delta256(x, 'A', 26, letters)),
+                                  delta256(x, '0', 10, digits));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi8(x, d));
+    }
+    return i;
+  }
+#endif
+};
@@ -0,0 +1,195 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @struct CandidateScore
+ * @brief Verdict of CandidateScorer on one candidate key.
+ */
+struct
+CandidateScore {
+  bool valid = false;      ///< Every byte decrypted to text.
+  size_t checked = 0;      ///< Bytes decrypted before the verdict.
+  size_t letters = 0;      ///< Letters and spaces seen in those bytes.
+  double likelihood = 0.0; ///< Sum of CandidateScorer::weights() over those bytes.
+
+  /**
+   * @brief Mean per-byte log-likelihood of the decryption (-infinity for rejected keys).
+   */
+  double
+  score() const {
+    return valid && checked ? likelihood / checked : -std::numeric_limits<double>::infinity();
+  }
+};
+
+/**
+ * @class CandidateScorer
+ * @brief Scores candidate keys directly against the ciphertext, without allocating.
+ *
+ * Decryption and the text check run in one pass: every decrypted byte is
+ * classified with a 256-entry table (the same bytes XOREncoder::isValidText
+ * accepts: printable ASCII and whitespace) and the candidate is rejected at
+ * the first byte that is not text. Survivors are ranked by the
+ * log-likelihood of their bytes in natural text, accumulated in the same
+ * pass. Callers build the plaintext only for the keys that survive.
+ */
+class
+CandidateScorer {
+public:
+  /**
+   * @brief Bits of classes().
+   */
+  enum Class : uint8_t {
+    TEXT = 1,    ///< Printable ASCII or whitespace.
+    LETTER = 2,  ///< a-z, A-Z.
+    SPACE = 4,   ///< ' ', '\t', '\n', '\v', '\f', '\r'.
+    DIGIT = 8    ///< 0-9.
+  };
+
+  /**
+   * @brief Class bits of every byte value.
+   */
+  static const std::array<uint8_t, 256>&
+  classes() {
+    static const std::array<uint8_t, 256> table = buildClasses();
+    return table;
+  }
+
+  /**
+   * @brief Log-likelihood of every byte value in English/Spanish text.
+   *
+   * Letters follow their frequency (uppercase ten times rarer), the space is
+   * the most common byte, punctuation and digits are plausible, UTF-8 bytes
+   * of accented letters are rare but allowed and control bytes are penalized.
+   */
+  static const std::array<double, 256>&
+  weights() {
+    static const std::array<double, 256> table = buildWeights();
+    return table;
+  }
+
+  /**
+   * @brief Mean per-byte log-likelihood of @p data (see weights()).
+   */
+  static double
+  textScore(const unsigned char* data, size_t size) {
+    const auto& weight = weights();
+    double total = 0.0;
+    for (size_t i = 0; i < size; ++i) {
+      total += weight[data[i]];
+    }
+    return size ? total / size : 0.0;
+  }
+
+  /**
+   * @brief Mean per-byte log-likelihood of @p cipher substituted through @p table, without the text check.
+   *
+   * For substitutions that leave every byte outside the alphabet unchanged
+   * (Caesar): those bytes, e.g. the UTF-8 bytes of accented letters, cost the
+   * same under every key and must not reject it.
+   */
+  static double
+  textScore(const unsigned char* cipher, size_t size, const std::array<unsigned char, 256>& table) {
+    const auto& weight = weights();
+    double total = 0.0;
+    for (size_t i = 0; i < size; ++i) {
+      total += weight[table[cipher[i]]];
+    }
+    return size ? total / size : 0.0;
+  }
+
+  /**
+   * @brief Whether every byte of @p data is text.
+   */
+  static bool
+  isText(const unsigned char* data, size_t size) {
+    const auto& cls = classes();
+    for (size_t i = 0; i < size; ++i) {
+      if (!(cls[data[i]] & TEXT)) return false;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Scores a decryption given byte by byte.
+   * @param size Number of bytes.
+   * @param next Callable returning the next decrypted byte on each call.
+   */
+  template<typename Next>
+  static CandidateScore
+  evaluate(size_t size, Next&& next) {
+    const auto& cls = classes();
+    const auto& weight = weights();
+    CandidateScore result;
+    for (size_t i = 0; i < size; ++i) {
+      unsigned char b = static_cast<unsigned char>(next());
+      uint8_t c = cls[b];
+      if (!(c & TEXT)) {
+        result.checked = i + 1;
+        return result;
+      }
+      result.letters += (c & (LETTER | SPACE)) != 0;
+      result.likelihood += weight[b];
+    }
+    result.valid = true;
+    result.checked = size;
+    return result;
+  }
+
+  /**
+   * @brief Scores a repeating XOR key.
+   * @param cipher Ciphertext bytes.
+   * @param size Number of bytes.
+   * @param key Key bytes.
+   * @param keySize Key length (at least 1).
+   * @param offset Position of @p cipher within the whole message.
+   */
+  static CandidateScore
+  evaluateXOR(const unsigned char* cipher, size_t size,
+              const unsigned char* key, size_t keySize, size_t offset = 0) {
+    size_t i = 0;
+    size_t k = offset % keySize;
+    return evaluate(size, [&]() {
+      unsigned char b = cipher[i++] ^ key[k];
+      if (++k == keySize) k = 0;
+      return b;
+    });
+  }
+
+private:
+  static std::array<double, 256>
+  buildWeights() {
+    static const double letters[26] = {
+      8.2, 1.5, 2.8, 4.3, 12.7, 2.2, 2.0, 6.1, 7.0, 0.15, 0.77, 4.0, 2.4,
+      6.7, 7.5, 1.9, 0.095, 6.0, 6.3, 9.1, 2.8, 0.98, 2.4, 0.15, 2.0, 0.074
+    };
+    std::array<double, 256> w;
+    for (int c = 0; c < 256; ++c) {
+      double p;
+      if (c >= 'a' && c <= 'z') p = letters[c - 'a'];
+      else if (c >= 'A' && c <= 'Z') p = letters[c - 'A'] * 0.1;
+      else if (c == ' ') p = 15.0;
+      else if (c == '.' || c == ',' || c == '\n') p = 1.0;
+      else if (c >= '0' && c <= '9') p = 0.3;
+      else if (c == '\'' || c == '"' || c == '-' || c == '(' || c == ')' || c == ';' ||
+               c == ':' || c == '!' || c == '?' || c == '\r') p = 0.2;
+      else if (c >= 32 && c < 127) p = 0.02;
+      else if (c >= 0xA0) p = 0.02;
+      else if (c == '\t') p = 0.05;
+      else p = 0.0001;
+      w[c] = std::log(p / 100.0);
+    }
+    return w;
+  }
+
+  static std::array<uint8_t, 256>
+  buildClasses() {
+    std::array<uint8_t, 256> t{};
+    for (int c = 0x20; c < 0x7F; ++c) t[c] = TEXT;
+    for (int c = '\t'; c <= '\r'; ++c) t[c] = TEXT | SPACE;
+    t[' '] |= SPACE;
+    for (int c = 'a'; c <= 'z'; ++c) t[c] |= LETTER;
+    for (int c = 'A'; c <= 'Z'; ++c) t[c] |= LETTER;
+    for (int c = '0'; c <= '9'; ++c) t[c] |= DIGIT;
+    return t;
+  }
+};
@@ -0,0 +1,316 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @struct AttackCandidate
+ * @brief One key proposed by a brute-force attack.
+ */
+struct
+AttackCandidate {
+  std::string key;        ///< Key bytes (Caesar: the shift as text).
+  double score = 0.0;     ///< Higher is better (see CandidateScore::score).
+  std::string plaintext;  ///< Decryption with this key.
+};
+
+/**
+ * @class CandidateWriter
+ * @brief Buffered, asynchronous JSONL or CSV output of attack candidates.
+ *
+ * Records are formatted into an in-memory buffer; full buffers are handed to
+ * a background thread that writes them to the file, so the attack never
+ * waits on the disk. Keys are also written in hex, since they may contain
+ * any byte. close() (or the destructor) flushes everything.
+ */
+class
+CandidateWriter {
+public:
+  /**
+   * @brief Output formats.
+   */
+  enum class Format {
+    JSONL,  ///< One JSON object per line.
+    CSV     ///< Header plus one row per candidate.
+  };
+
+  /**
+   * @brief Opens @p path and starts the writer thread.
+   * @param path Output file (truncated).
+   * @param format Record format.
+   * @throws std::runtime_error if the file cannot be created.
+   */
+  CandidateWriter(const std::string& path, Format format)
+    : m_out(path, std::ios::binary | std::ios::trunc), m_format(format) {
+    if (!m_out) throw std::runtime_error("Error al guardar el archivo: " + path);
+    if (m_format == Format::CSV) m_buffer = "attack,key,key_hex,score,plaintext\n";
+    m_thread = std::thread([this]() { writeLoop(); });
+  }
+
+  /**
+   * @brief Format implied by the extension of @p path: ".csv" is CSV, anything else JSONL.
+   */
+  static Format
+  formatOf(const std::string& path) {
+    std::string ext = std::filesystem::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) {
+      return static_cast<char>(std::tolower(c));
+    });
+    return ext == ".csv" ? Format::CSV : Format::JSONL;
+  }
+
+  ~CandidateWriter() {
+    close();
+  }
+
+  CandidateWriter(const CandidateWriter&) = delete;
+  CandidateWriter& operator=(const CandidateWriter&) = delete;
+
+  /**
+   * @brief Queues one record. Thread-safe.
+   * @param attack Name of the attack that produced the candidate.
+   * @param candidate The candidate.
+   */
+  void
+  write(const std::string& attack, const AttackCandidate& candidate) {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    if (m_format == Format::JSONL) {
+      m_buffer += "{\"attack\":";
+      appendJSON(m_buffer, attack);
+      m_buffer += ",\"key\":";
+      appendJSON(m_buffer, candidate.key);
+      m_buffer += ",\"key_hex\":\"";
+      appendHex(m_buffer, candidate.key);
+      m_buffer += "\",\"score\":";
+      m_buffer += std::to_string(candidate.score);
+      m_buffer += ",\"plaintext\":";
+      appendJSON(m_buffer, candidate.plaintext);
+      m_buffer += "}\n";
+    }
+    else {
+      appendCSV(m_buffer, attack);
+      m_buffer += ',';
+      appendCSV(m_buffer, candidate.key);
+      m_buffer += ',';
+      appendHex(m_buffer, candidate.key);
+      m_buffer += ',';
+      m_buffer += std::to_string(candidate.score);
+      m_buffer += ',';
+      appendCSV(m_buffer, candidate.plaintext);
+      m_buffer += '\n';
+    }
+
+    if (m_buffer.size() >= BUFFER_SIZE) {
+      m_queue.push_back(std::move(m_buffer));
+      m_buffer.clear();
+      m_cv.notify_one();
+    }
+  }
+
+  /**
+   * @brief Writes every queued record and stops the writer thread (idempotent).
+   */
+  void
+  close() {
+    {
+      std::lock_guard<std::mutex> lock(m_mtx);
+      if (m_closed) return;
+      if (!m_buffer.empty()) m_queue.push_back(std::move(m_buffer));
+      m_buffer.clear();
+      m_closed = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+    m_out.flush();
+  }
+
+private:
+  static constexpr size_t BUFFER_SIZE = size_t(1) << 16;
+
+  void
+  writeLoop() {
+    std::unique_lock<std::mutex> lock(m_mtx);
+    while (true) {
+      m_cv.wait(lock, [this]() { return !m_queue.empty() || m_closed; });
+      while (!m_queue.empty()) {
+        std::string block = std::move(m_queue.front());
+        m_queue.pop_front();
+        lock.unlock();
+        m_out.write(block.data(), static_cast<std::streamsize>(block.size()));
+        lock.lock();
+      }
+      if (m_closed) return;
+    }
+  }
+
+  static void
+  appendHex(std::string& out, const std::string& bytes) {
+    static const char digits[] = "0123456789abcdef";
+    for (unsigned char c : bytes) {
+      out += digits[c >> 4];
+      out += digits[c & 15];
+    }
+  }
+
+  /**
+   * @brief Appends a JSON string; bytes outside printable ASCII become \\u00XX.
+   */
+  static void
+  appendJSON(std::string& out, const std::string& text) {
+    static const char digits[] = "0123456789abcdef";
+    out += '"';
+    for (unsigned char c : text) {
+      if (c == '"' || c == '\\') {
+        out += '\\';
+        out += static_cast<char>(c);
+      }
+      else if (c < 0x20 || c >= 0x7F) {
+        out += "\\u00";
+        out += digits[c >> 4];
+        out += digits[c & 15];
+      }
+      else {
+        out += static_cast<char>(c);
+      }
+    }
+    out += '"';
+  }
+
+  /**
+   * @brief Appends a quoted CSV field (quotes doubled).
+   */
+  static void
+  appendCSV(std::string& out, const std::string& text) {
+    out += '"';
+    for (char c : text) {
+      if (c == '"') out += '"';
+      out += c;
+    }
+    out += '"';
+  }
+
+  std::ofstream m_out;               ///< Output file.
+  Format m_format;                   ///< Record format.
+  std::string m_buffer;              ///< Records not yet handed to the writer thread.
+  std::deque<std::string> m_queue;   ///< Full buffers waiting to be written.
+  std::mutex m_mtx;                  ///< Guards m_buffer, m_queue and m_closed.
+  std::condition_variable m_cv;      ///< Wakes the writer thread.
+  bool m_closed = false;             ///< close() was called.
+  std::thread m_thread;              ///< Writer thread.
+};
+
+/**
+ * @class CandidateSink
+ * @brief Collects attack candidates: keeps the best K and optionally streams all of them.
+ *
+ * The K best candidates are held in a min-heap, so adding one costs
+ * O(log K) and memory stays bounded however many keys survive. Attacks call
+ * accepts() before building a plaintext, so keys that cannot enter the
+ * ranking (and are not being written out) cost nothing; they call note()
+ * for every valid key first, so valid() counts them all. Thread-safe.
+ */
+class
+CandidateSink {
+public:
+  /**
+   * @brief Constructs the sink.
+   * @param capacity Number of best candidates kept (K).
+   * @param writer Optional output for every candidate added; must outlive the sink.
+   * @param attack Attack name written with each record.
+   */
+  explicit CandidateSink(size_t capacity = 10, CandidateWriter* writer = nullptr,
+                         const std::string& attack = "")
+    : m_capacity(std::max<size_t>(1, capacity)), m_writer(writer), m_attack(attack) {}
+
+  ~CandidateSink() = default;
+
+  /**
+   * @brief Names the attack written with each record (attacks set it themselves).
+   */
+  void
+  setAttack(const std::string& attack) {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_attack = attack;
+  }
+
+  /**
+   * @brief Counts one valid candidate, whether or not it is then added.
+   */
+  void
+  note() {
+    m_valid.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Whether a candidate with @p score would be kept or written.
+   */
+  bool
+  accepts(double score) const {
+    if (m_writer != nullptr) return true;
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return m_heap.size() < m_capacity || score > m_heap.front().score;
+  }
+
+  /**
+   * @brief Adds a candidate.
+   */
+  void
+  add(AttackCandidate candidate) {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    ++m_total;
+    if (m_writer != nullptr) m_writer->write(m_attack, candidate);
+
+    if (m_heap.size() < m_capacity) {
+      m_heap.push_back(std::move(candidate));
+      std::push_heap(m_heap.begin(), m_heap.end(), worse);
+    }
+    else if (candidate.score > m_heap.front().score) {
+      std::pop_heap(m_heap.begin(), m_heap.end(), worse);
+      m_heap.back() = std::move(candidate);
+      std::push_heap(m_heap.begin(), m_heap.end(), worse);
+    }
+  }
+
+  /**
+   * @brief The kept candidates, best first.
+   */
+  std::vector<AttackCandidate>
+  results() const {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    std::vector<AttackCandidate> sorted(m_heap);
+    std::sort(sorted.begin(), sorted.end(), [](const AttackCandidate& a, const AttackCandidate& b) {
+      return a.score > b.score;
+    });
+    return sorted;
+  }
+
+  /**
+   * @brief Number of candidates added so far (kept or not).
+   */
+  uint64_t
+  total() const {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return m_total;
+  }
+
+  /**
+   * @brief Number of valid candidates noted so far (see note()), added or not.
+   */
+  uint64_t
+  valid() const {
+    return m_valid.load(std::memory_order_relaxed);
+  }
+
+private:
+  /// Heap order: the worst kept candidate sits at the front.
+  static bool
+  worse(const AttackCandidate& a, const AttackCandidate& b) {
+    return a.score > b.score;
+  }
+
+  size_t m_capacity;                   ///< K.
+  CandidateWriter* m_writer;           ///< Optional output of every candidate.
+  std::string m_attack;                ///< Attack name written with each record.
+  std::vector<AttackCandidate> m_heap; ///< Best candidates, min-heap by score.
+  uint64_t m_total = 0;                ///< Candidates added.
+  mutable std::mutex m_mtx;            ///< Guards everything above.
+  std::atomic<uint64_t> m_valid{ 0 };  ///< Valid candidates noted.
+};
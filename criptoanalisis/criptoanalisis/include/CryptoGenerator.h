@@ -84,12 +84,15 @@ public:
 	// Convierte bytes a cadena hexadecimal
 	std::string
 	toHex(const std::vector<uint8_t>& data) {
-		std::ostringstream oss;
+		static const char digits[] = "0123456789abcdef";
+		std::string hex(data.size() * 2, '0');
 
-    for (const auto& byte : data) {
-      oss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(byte);
+    // Tabla de dgitos en lugar de ostringstream: un archivo grande se convierte en un solo paso
+    for (size_t i = 0; i < data.size(); ++i) {
+      hex[2 * i] = digits[data[i] >> 4];
+      hex[2 * i + 1] = digits[data[i] & 0x0F];
     }
-    return oss.str();  // Devuelve la representacin hexadecimal como cadena.
+    return hex;  // Devuelve la representacin hexadecimal como cadena.
 	}
 
   // Decodifica una cadena hexadecimal a bytes
@@ -8,10 +8,17 @@
  * This class provides methods for key scheduling, initial and final permutations, expansion,
  * substitution using S-boxes, permutation, and the Feistel function. It supports encoding
  * a 64-bit plaintext block using a 64-bit key.
+ *
+ * The round function is table driven: the S-box and the P permutation are fused into
+ * eight precomputed SP tables built at compile time, and the halves are processed as
+ * plain 32-bit words. See BitslicedDES.h for the multi-block backend.
  */
-class 
+class
 DES {
 public:
+  /// The 16 round subkeys, one 48-bit value per round.
+  using Subkeys = std::array<uint64_t, 16>;
+
   /**
    * @brief Default constructor.
    */
@@ -30,17 +37,36 @@ public:
    */
   ~DES() = default;
 
+  /**
+   * @brief Replaces the key and recomputes the subkeys without allocating.
+   * @param newKey The new 64-bit key.
+   */
+  void
+  rekey(const std::bitset<64>& newKey) {
+    key = newKey;
+    generateSubkeys();
+  }
+
   /**
    * @brief Generates 16 subkeys for the 16 DES rounds.
    *
    * This simplified version creates subkeys by rotating and masking the main key.
    */
-  void 
+  void
   generateSubkeys() {
+    scheduleSubkeys(key.to_ullong(), subkeys);
+  }
+
+  /**
+   * @brief Computes the 16 subkeys of a key into a fixed array (no allocation).
+   * @param key The 64-bit key as a plain word.
+   * @param out Destination array, one 48-bit subkey per round.
+   */
+  static void
+  scheduleSubkeys(uint64_t key, Subkeys& out) {
     for (int i = 0; i < 16; ++i) {
       // Simplificada: subclave fija con rotacin de bits
-      std::bitset<48> subkey((key.to_ullong() >> i) & 0xFFFFFFFFFFFF);
-      subkeys.push_back(subkey);
+      out[i] = (key >> i) & 0xFFFFFFFFFFFFULL;
     }
   }
 
@@ -49,29 +75,19 @@ public:
    * @param input The 64-bit input block.
    * @return The permuted 64-bit block.
    */
-  std::bitset<64>
-  iPermutation(const std::bitset<64>& input) {
-    std::bitset<64> output;
-    for (int i = 0; i < 64; i++) {
-      output[i] = input[i];
-    }
-    return output;
+  static uint64_t
+  iPermutation(uint64_t input) {
+    return input;
   }
 
   /**
    * @brief Expands a 32-bit half-block to 48 bits using the expansion table.
    * @param halfBlock The 32-bit input half-block.
-   * @return The expanded 48-bit block.
+   * @return The expanded 48-bit block in the low bits of the result.
    */
-  std::bitset<48>
-  expand(const std::bitset<32>& halfBlock) {
-    std::bitset<48> output;
-
-    for (int i = 0; i < 48; i++) {
-      output[i] = halfBlock[32 - EXPANSION_TABLE[i]];
-    }
-
-    return output;
+  static uint64_t
+  expand(uint32_t halfBlock) {
+    return expandReversed(reverse32(halfBlock));
   }
 
   /**
@@ -79,35 +95,48 @@ public:
    * @param input The 48-bit input block.
    * @return The substituted 32-bit block.
    */
-  std::bitset<32>
-  substitute(const std::bitset<48>& input) {
-    std::bitset<32> output;
+  static constexpr uint32_t
+  substitute(uint64_t input) {
+    uint32_t output = 0;
 
     for (int i = 0; i < 8; i++) {
-      int row = (input[i * 6] << 1) | input[i * 6 + 5]; // Bits 1 y 6
-      int col = (input[i * 6 + 1] << 3) | (input[i * 6 + 2] << 2) |
-        (input[i * 6 + 3] << 1) | input[i * 6 + 4]; // Bits 2-5
-      int sboxValue = SBOX[row % 4][col % 16]; // Valor de la S-Box
-
-      for (int j = 0; j < 4; j++) {
-        output[i * 4 + j] = (sboxValue >> (3 - j)) & 1; // Extraer bits
-      }
+      output |= substituteBox(i, static_cast<int>((input >> (i * 6)) & 0x3F));
     }
 
     return output;
   }
 
+  /**
+   * @brief Substitutes the 6-bit input of one S-box position.
+   * @param box The S-box position (0-7).
+   * @param chunk The 6 input bits of that box, bit 0 first.
+   * @return The 4 output bits placed at bits 4 * box ... 4 * box + 3.
+   */
+  static constexpr uint32_t
+  substituteBox(int box, int chunk) {
+    int row = ((chunk & 1) << 1) | ((chunk >> 5) & 1); // Bits 1 y 6
+    int col = (((chunk >> 1) & 1) << 3) | (((chunk >> 2) & 1) << 2) |
+      (((chunk >> 3) & 1) << 1) | ((chunk >> 4) & 1); // Bits 2-5
+    int sboxValue = SBOX[row][col]; // Valor de la S-Box
+
+    uint32_t output = 0;
+    for (int j = 0; j < 4; j++) {
+      output |= static_cast<uint32_t>((sboxValue >> (3 - j)) & 1) << (box * 4 + j); // Extraer bits
+    }
+    return output;
+  }
+
   /**
    * @brief Applies the P permutation to a 32-bit input block.
    * @param input The 32-bit input block.
    * @return The permuted 32-bit block.
    */
-  std::bitset<32> 
-  permuteP(const std::bitset<32>& input) {
-    std::bitset<32> output;
+  static constexpr uint32_t
+  permuteP(uint32_t input) {
+    uint32_t output = 0;
 
     for (int i = 0; i < 32; i++) {
-      output[i] = input[32 - P_TABLE[i]];
+      output |= ((input >> (32 - P_TABLE[i])) & 1u) << i;
     }
 
     return output;
@@ -119,13 +148,9 @@ public:
    * @param subkey The 48-bit subkey for the round.
    * @return The 32-bit output of the Feistel function.
    */
-  std::bitset<32>
-  feistel(const std::bitset<32>& right, const std::bitset<48>& subkey) {
-    auto expandend = expand(right);
-    auto xored = expandend ^ subkey;
-    auto substituted = substitute(xored);
-    auto permuted = permuteP(substituted);
-    return permuted;
+  static uint32_t
+  feistel(uint32_t right, uint64_t subkey) {
+    return reverse32(feistelReversed(reverse32(right), subkey));
   }
 
   /**
@@ -133,13 +158,9 @@ public:
    * @param input The 64-bit input block.
    * @return The permuted 64-bit block.
    */
-  std::bitset<64>
-  fPermutation(const std::bitset<64>& input) {
-    std::bitset<64> output;
-    for (int i = 0; i < 64; i++) {
-      output[i] = input[i];
-    }
-    return output;
+  static uint64_t
+  fPermutation(uint64_t input) {
+    return input;
   }
 
   /**
@@ -147,36 +168,39 @@ public:
    * @param plaintext The 64-bit plaintext block.
    * @return The 64-bit ciphertext block.
    */
-  std::bitset<64> 
+  std::bitset<64>
   encode(const std::bitset<64>& plaintext) {
-    auto data = iPermutation(plaintext);
-    std::bitset<32> left(data.to_ullong() >> 32);
-    std::bitset<32> right(data.to_ullong());
-
-    for (int round = 0; round < 16; round++) {
-      auto newRight = left ^ feistel(right, subkeys[round]);
-      left = right;
-      right = newRight;
-    }
-
-    uint64_t combined = (static_cast<uint64_t>(right.to_ullong()) << 32) | left.to_ullong();
-    return fPermutation(std::bitset<64>(combined));
+    return std::bitset<64>(encodeBlock(plaintext.to_ullong()));
   }
 
+  /**
+   * @brief Decrypts a 64-bit ciphertext block using the DES algorithm.
+   * @param ciphertext The 64-bit ciphertext block.
+   * @return The 64-bit plaintext block.
+   */
   std::bitset<64>
-  decode(const std::bitset<64>& plaintext) {
-    auto data = iPermutation(plaintext);
-    std::bitset<32> left(data.to_ullong() >> 32);
-    std::bitset<32> right(data.to_ullong());
+  decode(const std::bitset<64>& ciphertext) {
+    return std::bitset<64>(decodeBlock(ciphertext.to_ullong()));
+  }
 
-    for (int round = 15; round >= 0; --round) {
-      auto newRight = left ^ feistel(right, subkeys[round]);
-      left = right;
-      right = newRight;
-    }
+  /**
+   * @brief Encrypts a block held in a plain 64-bit word.
+   * @param plaintext The block, in the numeric format of std::bitset<64>::to_ullong().
+   * @return The encrypted block.
+   */
+  uint64_t
+  encodeBlock(uint64_t plaintext) const {
+    return rounds(subkeys, plaintext, false);
+  }
 
-    uint64_t combined = (static_cast<uint64_t>(right.to_ullong()) << 32) | left.to_ullong();
-    return fPermutation(std::bitset<64>(combined));
+  /**
+   * @brief Decrypts a block held in a plain 64-bit word.
+   * @param ciphertext The encrypted block.
+   * @return The decrypted block.
+   */
+  uint64_t
+  decodeBlock(uint64_t ciphertext) const {
+    return rounds(subkeys, ciphertext, true);
   }
 
   std::bitset<64>
@@ -188,7 +212,7 @@ public:
     return std::bitset<64>(bits);
   }
 
-  std::string 
+  std::string
   bitset64ToString(const std::bitset<64>& bits) {
     std::string result(8, '\0');
     uint64_t val = bits.to_ullong();
@@ -200,14 +224,41 @@ public:
     return result;
   }
 
-private:
-  std::bitset<64> key; ///< The 64-bit encryption key.
-  std::vector<std::bitset<48>> subkeys; ///< The 16 subkeys for each DES round.
+  /**
+   * @brief Reads up to 8 bytes as a big-endian block (same layout as stringToBitset64).
+   * @param bytes Pointer to the bytes.
+   * @param len Number of bytes available; missing bytes are zero.
+   * @return The block as a 64-bit word.
+   */
+  static uint64_t
+  loadBlock(const unsigned char* bytes, size_t len = 8) {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < 8; i++) {
+      bits = (bits << 8) | (i < len ? bytes[i] : 0);
+    }
+    return bits;
+  }
+
+  /**
+   * @brief Writes the first @p len bytes of a block in big-endian order.
+   * @param block The 64-bit block.
+   * @param bytes Destination buffer.
+   * @param len Number of bytes to write (at most 8).
+   */
+  static void
+  storeBlock(uint64_t block, unsigned char* bytes, size_t len = 8) {
+    for (size_t i = 0; i < len; i++) {
+      bytes[i] = static_cast<unsigned char>(block >> ((7 - i) * 8));
+    }
+  }
 
   /**
    * @brief Expansion table for expanding 32 bits to 48 bits.
+   *
+   * The tables are shared by every DES instance and by the alternative
+   * backends (see BitslicedDES.h), so they are static constexpr data.
    */
-  const int
+  static constexpr int
   EXPANSION_TABLE[48] = {
       32, 1, 2, 3, 4, 5,
       4, 5, 6, 7, 8, 9,
@@ -222,7 +273,7 @@ private:
   /**
    * @brief Permutation table P (simplified).
    */
-  const int
+  static constexpr int
   P_TABLE[32] = {
       16, 7, 20, 21,29,12,28,17,
        1,15,23,26, 5,18,31,10,
@@ -233,11 +284,207 @@ private:
   /**
    * @brief Simplified S-Box for substitution.
    */
-  const int 
+  static constexpr int
   SBOX[4][16] = {
       {14,4,13,1,2,15,11,8,3,10,6,12,5,9,0,7},
       {0,15,7,4,14,2,13,1,10,6,12,11,9,5,3,8},
       {4,1,14,8,13,6,2,11,15,12,9,7,3,10,5,0},
       {15,12,8,2,4,9,1,7,5,11,3,14,10,0,6,13}
   };
-};
\ No newline at end of file
+
+  /**
+   * @brief Reverses the bit order of a 32-bit word.
+   */
+  static constexpr uint32_t
+  reverse32(uint32_t x) {
+    x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+    x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+    x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+    x = ((x >> 8) & 0x00FF00FFu) | ((x & 0x00FF00FFu) << 8);
+    return (x >> 16) | (x << 16);
+  }
+
+  /**
+   * @brief Combined S-box + P tables, one per S-box position.
+   *
+   * SP[k][v] is the P-permuted contribution of box k for the 6-bit input v,
+   * stored bit-reversed (see feistelReversed). Built once at compile time.
+   */
+  static const std::array<std::array<uint32_t, 64>, 8>&
+  spTables();
+
+  /**
+   * @brief Expansion of a bit-reversed half-block using only shifts and masks.
+   *
+   * Box k reads the six consecutive (circular) bits 4k - 1 ... 4k + 4 of the
+   * reversed half, which is exactly the EXPANSION_TABLE layout.
+   */
+  static uint64_t
+  expandReversed(uint32_t reversed) {
+    uint32_t t = (reversed << 1) | (reversed >> 31);
+    uint64_t wrap = ((t >> 28) | (t << 4)) & 0x3F;
+    return  (uint64_t)(t & 0x3F)
+      | ((uint64_t)((t >> 4) & 0x3F) << 6)
+      | ((uint64_t)((t >> 8) & 0x3F) << 12)
+      | ((uint64_t)((t >> 12) & 0x3F) << 18)
+      | ((uint64_t)((t >> 16) & 0x3F) << 24)
+      | ((uint64_t)((t >> 20) & 0x3F) << 30)
+      | ((uint64_t)((t >> 24) & 0x3F) << 36)
+      | (wrap << 42);
+  }
+
+  /**
+   * @brief Feistel function over bit-reversed halves using the SP tables.
+   * @param reversed The right half with its bit order reversed.
+   * @param subkey The 48-bit subkey for the round.
+   * @return The Feistel output, bit-reversed.
+   */
+  static uint32_t
+  feistelReversed(uint32_t reversed, uint64_t subkey) {
+    const auto& sp = spTables();
+    uint32_t t = (reversed << 1) | (reversed >> 31);
+    uint32_t k0 = static_cast<uint32_t>(subkey);
+    uint32_t k1 = static_cast<uint32_t>(subkey >> 24);
+    uint32_t wrap = (t >> 28) | (t << 4);
+    return sp[0][(t ^ k0) & 0x3F]
+      ^ sp[1][((t >> 4) ^ (k0 >> 6)) & 0x3F]
+      ^ sp[2][((t >> 8) ^ (k0 >> 12)) & 0x3F]
+      ^ sp[3][((t >> 12) ^ (k0 >> 18)) & 0x3F]
+      ^ sp[4][((t >> 16) ^ k1) & 0x3F]
+      ^ sp[5][((t >> 20) ^ (k1 >> 6)) & 0x3F]
+      ^ sp[6][((t >> 24) ^ (k1 >> 12)) & 0x3F]
+      ^ sp[7][(wrap ^ (k1 >> 18)) & 0x3F];
+  }
+
+  /**
+   * @brief The Feistel rounds; both halves are kept bit-reversed throughout.
+   * @tparam Rounds Number of rounds (16 for DES, fewer for reduced-round analysis).
+   * @param subkeys The key schedule to use (the first @p Rounds subkeys).
+   * @param block The input block.
+   * @param decrypt Whether to apply the subkeys in reverse order.
+   * @return The output block.
+   */
+  template<int Rounds = 16>
+  static uint64_t
+  rounds(const Subkeys& subkeys, uint64_t block, bool decrypt) {
+    static_assert(Rounds >= 1 && Rounds <= 16, "DES has between 1 and 16 rounds");
+    uint64_t data = iPermutation(block);
+    uint32_t left = reverse32(static_cast<uint32_t>(data >> 32));
+    uint32_t right = reverse32(static_cast<uint32_t>(data));
+
+    for (int r = 0; r < Rounds; r++) {
+      uint64_t subkey = subkeys[decrypt ? Rounds - 1 - r : r];
+      uint32_t newRight = left ^ feistelReversed(right, subkey);
+      left = right;
+      right = newRight;
+    }
+
+    uint64_t combined = (static_cast<uint64_t>(reverse32(right)) << 32) | reverse32(left);
+    return fPermutation(combined);
+  }
+
+private:
+  static constexpr std::array<std::array<uint32_t, 64>, 8>
+  buildSPTables() {
+    std::array<std::array<uint32_t, 64>, 8> tables{};
+    for (int k = 0; k < 8; ++k) {
+      for (int v = 0; v < 64; ++v) {
+        tables[k][v] = reverse32(permuteP(substituteBox(k, v)));
+      }
+    }
+    return tables;
+  }
+
+  std::bitset<64> key; ///< The 64-bit encryption key.
+  Subkeys subkeys{}; ///< The 16 48-bit subkeys for each DES round.
+};
+
+inline const std::array<std::array<uint32_t, 64>, 8>&
+DES::spTables() {
+  static constexpr std::array<std::array<uint32_t, 64>, 8> tables = buildSPTables();
+  return tables;
+}
+
+/**
+ * @struct DESKeyContext
+ * @brief Lightweight, trivially copyable DES key schedule.
+ *
+ * Holds only the 16 subkeys (128 bytes); the tables are the shared static
+ * data of DES. rekey() runs without allocating, so one context can be reused
+ * for millions of keys, and rekeyBatch() schedules many keys in one loop.
+ */
+struct
+DESKeyContext {
+  DES::Subkeys subkeys; ///< The 16 48-bit subkeys.
+
+  /**
+   * @brief Builds a context for one key.
+   * @param key The 64-bit key as a plain word.
+   */
+  static DESKeyContext
+  fromKey(uint64_t key) {
+    DESKeyContext ctx;
+    ctx.rekey(key);
+    return ctx;
+  }
+
+  /**
+   * @brief Replaces the key schedule in place.
+   * @param key The new 64-bit key.
+   */
+  void
+  rekey(uint64_t key) {
+    DES::scheduleSubkeys(key, subkeys);
+  }
+
+  /**
+   * @brief Computes the key schedules of @p count keys.
+   * @param keys Input keys.
+   * @param contexts Output contexts, one per key.
+   * @param count Number of keys.
+   */
+  static void
+  rekeyBatch(const uint64_t* keys, DESKeyContext* contexts, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      contexts[i].rekey(keys[i]);
+    }
+  }
+
+  /**
+   * @brief Encrypts one block (same result as DES::encodeBlock).
+   */
+  uint64_t
+  encodeBlock(uint64_t plaintext) const {
+    return DES::rounds(subkeys, plaintext, false);
+  }
+
+  /**
+   * @brief Decrypts one block (same result as DES::decodeBlock).
+   */
+  uint64_t
+  decodeBlock(uint64_t ciphertext) const {
+    return DES::rounds(subkeys, ciphertext, true);
+  }
+};
+
+static_assert(std::is_trivially_copyable<DESKeyContext>::value,
+              "DESKeyContext must stay trivially copyable");
+
+/**
+ * Converts a text key (up to 8 characters) to a 64-bit bitset.
+ * Pads with zeros if the key is shorter than 8 characters.
+ * @param input The text key to convert.
+ * @return std::bitset<64> representing the key.
+ */
+inline std::bitset<64>
+convertTextKeyToBitset64(const std::string& input) {
+  std::bitset<64> bits(0);
+  int len = std::min(8, static_cast<int>(input.size()));
+  for (int i = 0; i < len; ++i) {
+    uint8_t c = static_cast<uint8_t>(input[i]);
+    bits <<= 8;
+    bits |= std::bitset<64>(c);
+  }
+  bits <<= (8 - len) * 8;
+  return bits;
+}
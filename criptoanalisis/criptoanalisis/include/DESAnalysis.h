@@ -0,0 +1,290 @@
+#pragma once
+#include "Prerequisites.h"
+#include "DES.h"
+#include "BitslicedDES.h"
+#include "Parallel.h"
+
+/**
+ * @class SBoxAnalysis
+ * @brief Difference distribution and linear approximation tables of DES::SBOX.
+ *
+ * The S-box is seen as the 6-to-4-bit function S(v) = DES::substituteBox(0, v),
+ * with the same bit order the cipher uses, so the tables apply directly to
+ * the rounds of DES. Both tables are built at compile time.
+ */
+class
+SBoxAnalysis {
+public:
+  using Table = std::array<std::array<int, 16>, 64>;
+
+  /**
+   * @brief One table entry: input mask/difference, output mask/difference and value.
+   */
+  struct
+  Entry {
+    int input;
+    int output;
+    int value;
+  };
+
+  /**
+   * @brief S-box output for the 6-bit input @p v.
+   */
+  static constexpr int
+  sbox(int v) {
+    return static_cast<int>(DES::substituteBox(0, v));
+  }
+
+  /**
+   * @brief Parity of the bits of @p v.
+   */
+  static constexpr int
+  parity(uint32_t v) {
+    v ^= v >> 16;
+    v ^= v >> 8;
+    v ^= v >> 4;
+    v ^= v >> 2;
+    v ^= v >> 1;
+    return static_cast<int>(v & 1);
+  }
+
+  /**
+   * @brief Difference distribution table: DDT[dx][dy] = #{x : S(x) ^ S(x ^ dx) = dy}.
+   */
+  static const Table&
+  ddt();
+
+  /**
+   * @brief Linear approximation table: LAT[a][b] = #{x : a.x = b.S(x)} - 32.
+   */
+  static const Table&
+  lat();
+
+  /**
+   * @brief The @p count most likely non-trivial differentials (dx != 0).
+   */
+  static std::vector<Entry>
+  bestDifferentials(size_t count) {
+    return best(ddt(), count, false);
+  }
+
+  /**
+   * @brief The @p count linear approximations with the largest |bias| (b != 0).
+   */
+  static std::vector<Entry>
+  bestApproximations(size_t count) {
+    return best(lat(), count, true);
+  }
+
+  static constexpr Table
+  buildDDT() {
+    Table t{};
+    for (int dx = 0; dx < 64; ++dx) {
+      for (int x = 0; x < 64; ++x) {
+        ++t[dx][sbox(x) ^ sbox(x ^ dx)];
+      }
+    }
+    return t;
+  }
+
+  static constexpr Table
+  buildLAT() {
+    Table t{};
+    for (int a = 0; a < 64; ++a) {
+      for (int b = 0; b < 16; ++b) {
+        int agree = 0;
+        for (int x = 0; x < 64; ++x) {
+          agree += parity(static_cast<uint32_t>(a & x)) == parity(static_cast<uint32_t>(b & sbox(x)));
+        }
+        t[a][b] = agree - 32;
+      }
+    }
+    return t;
+  }
+
+private:
+  static std::vector<Entry>
+  best(const Table& table, size_t count, bool linear) {
+    std::vector<Entry> entries;
+    for (int i = linear ? 0 : 1; i < 64; ++i) {
+      for (int o = linear ? 1 : 0; o < 16; ++o) {
+        entries.push_back({ i, o, table[i][o] });
+      }
+    }
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+      return std::abs(a.value) > std::abs(b.value);
+    });
+    if (entries.size() > count) entries.resize(count);
+    return entries;
+  }
+};
+
+inline const SBoxAnalysis::Table&
+SBoxAnalysis::ddt() {
+  static constexpr Table table = buildDDT();
+  return table;
+}
+
+inline const SBoxAnalysis::Table&
+SBoxAnalysis::lat() {
+  static constexpr Table table = buildLAT();
+  return table;
+}
+
+/**
+ * @struct DESDifferentialResult
+ * @brief Outcome of a DESDifferentialExperiment run.
+ */
+struct
+DESDifferentialResult {
+  int rounds = 0;              ///< Number of rounds of the cipher.
+  uint64_t pairs = 0;          ///< Chosen plaintext pairs encrypted.
+  uint64_t matches = 0;        ///< Pairs whose output difference matched.
+  double probability = 0.0;    ///< matches / pairs.
+  double seconds = 0.0;        ///< Wall-clock time.
+  double pairsPerSecond = 0.0; ///< Average rate.
+};
+
+/**
+ * @class DESDifferentialExperiment
+ * @brief Counts how often an input difference leads to an output difference
+ *        in reduced-round DES, over many random chosen plaintext pairs.
+ *
+ * The plaintexts are drawn directly in bitsliced form (every bit slice is a
+ * random word), the partner of each plaintext is obtained by flipping the
+ * slices of the input difference, and both sets go through
+ * BitslicedDES::encodeSlices<Rounds>, so no block is ever transposed. Matches
+ * are counted with a popcount per word and batches are spread across cores.
+ */
+class
+DESDifferentialExperiment {
+public:
+  using Engine = BitslicedDESNative;
+  using Slice = Engine::Slice;
+
+  /**
+   * @brief Constructs the experiment.
+   * @param key The 64-bit key used for every pair.
+   * @param threads Worker threads (0 = all cores).
+   * @param seed Seed of the plaintext generator (runs are reproducible).
+   */
+  DESDifferentialExperiment(const std::bitset<64>& key, unsigned int threads = 0, uint64_t seed = 1)
+    : m_engine(key), m_threads(threads), m_seed(seed) {}
+
+  ~DESDifferentialExperiment() = default;
+
+  /**
+   * @brief Runs the experiment on @p Rounds-round DES.
+   * @tparam Rounds Number of rounds (1-16), specialized at compile time.
+   * @param inputDiff Difference between the two plaintexts of a pair.
+   * @param outputDiff Expected difference between the ciphertexts.
+   * @param outputMask Ciphertext bits that are compared (~0 = all).
+   * @param pairs Number of pairs (rounded up to a multiple of Engine::BLOCKS).
+   */
+  template<int Rounds>
+  DESDifferentialResult
+  run(uint64_t inputDiff, uint64_t outputDiff, uint64_t outputMask, uint64_t pairs) const {
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+
+    Slice diff[64];
+    for (int b = 0; b < 64; ++b) {
+      diff[b] = ((inputDiff >> b) & 1) ? Slice::ones() : Slice::zero();
+    }
+    int compared[64];
+    bool expected[64];
+    int comparedCount = 0;
+    for (int b = 0; b < 64; ++b) {
+      if ((outputMask >> b) & 1) {
+        expected[comparedCount] = ((outputDiff >> b) & 1) != 0;
+        compared[comparedCount++] = b;
+      }
+    }
+
+    uint64_t batches = (pairs + Engine::BLOCKS - 1) / Engine::BLOCKS;
+    std::atomic<uint64_t> matches{ 0 };
+    Parallel::forRange(static_cast<size_t>(batches), m_threads, 16, [&](size_t begin, size_t end) {
+      uint64_t local = 0;
+      Slice a[64], b[64];
+
+      for (size_t batch = begin; batch < end; ++batch) {
+        // Every batch has its own position in the stream: same pairs for any thread count
+        uint64_t state = m_seed * 0xD6E8FEB86659FD93ULL + batch * 64 * Engine::BLOCKS * GOLDEN;
+        for (int i = 0; i < 64; ++i) {
+          for (size_t w = 0; w < Engine::BLOCKS / 64; ++w) {
+            a[i].set(w, next(state));
+          }
+          b[i] = a[i] ^ diff[i];
+        }
+        m_engine.template encodeSlices<Rounds>(a);
+        m_engine.template encodeSlices<Rounds>(b);
+
+        Slice mismatch = Slice::zero();
+        for (int i = 0; i < comparedCount; ++i) {
+          Slice d = a[compared[i]] ^ b[compared[i]];
+          mismatch |= expected[i] ? ~d : d;
+        }
+        for (size_t w = 0; w < Engine::BLOCKS / 64; ++w) {
+          local += popcount64(~mismatch.get(w));
+        }
+      }
+      matches += local;
+    });
+
+    DESDifferentialResult result;
+    result.rounds = Rounds;
+    result.pairs = batches * Engine::BLOCKS;
+    result.matches = matches.load();
+    result.probability = result.pairs ? static_cast<double>(result.matches) / result.pairs : 0.0;
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.pairsPerSecond = result.seconds > 0 ? result.pairs / result.seconds : 0.0;
+    return result;
+  }
+
+  /**
+   * @brief Same as run<Rounds>() with the round count chosen at runtime.
+   * @throws std::invalid_argument if @p rounds is not between 1 and 16.
+   */
+  DESDifferentialResult
+  run(int rounds, uint64_t inputDiff, uint64_t outputDiff, uint64_t outputMask, uint64_t pairs) const {
+    if (rounds < 1 || rounds > 16) {
+      throw std::invalid_argument("El numero de rondas debe estar entre 1 y 16.");
+    }
+    static const auto table = dispatchTable(std::make_integer_sequence<int, 16>{});
+    return (this->*table[rounds - 1])(inputDiff, outputDiff, outputMask, pairs);
+  }
+
+private:
+  using RunFn = DESDifferentialResult (DESDifferentialExperiment::*)(uint64_t, uint64_t, uint64_t, uint64_t) const;
+
+  template<int... R>
+  static std::array<RunFn, sizeof...(R)>
+  dispatchTable(std::integer_sequence<int, R...>) {
+    return { { &DESDifferentialExperiment::run<R + 1>... } };
+  }
+
+  static constexpr uint64_t GOLDEN = 0x9E3779B97F4A7C15ULL;
+
+  /**
+   * @brief splitmix64 generator.
+   */
+  static uint64_t
+  next(uint64_t& state) {
+    uint64_t z = (state += GOLDEN);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  static uint64_t
+  popcount64(uint64_t v) {
+    v = v - ((v >> 1) & 0x5555555555555555ULL);
+    v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+    v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (v * 0x0101010101010101ULL) >> 56;
+  }
+
+  Engine m_engine;        ///< Bitsliced engine with the key in every lane.
+  unsigned int m_threads; ///< Worker threads (0 = all cores).
+  uint64_t m_seed;        ///< Seed of the plaintext generator.
+};
@@ -0,0 +1,326 @@
+#pragma once
+#include "Prerequisites.h"
+#include "DES.h"
+#include "BitslicedDES.h"
+#include "DESBatch.h"
+#include "Parallel.h"
+
+/**
+ * @class DESKeyMask
+ * @brief Describes a keyspace of text keys position by position.
+ *
+ * Mask syntax (one token per key character, at most 8 characters):
+ *  - ?l lowercase letters, ?u uppercase letters, ?d digits,
+ *  - ?s symbols, ?a all printable ASCII,
+ *  - ?? a literal '?', any other character is a literal.
+ *
+ * Example: "?l?l?l?l?l?l?d?d" = 6 lowercase letters followed by 2 digits.
+ */
+class
+DESKeyMask {
+public:
+  DESKeyMask() = default;
+
+  /**
+   * @brief Parses a mask.
+   * @param mask The mask string.
+   * @throws std::invalid_argument if the mask is empty, longer than 8 characters
+   *         or uses an unknown ?x token.
+   */
+  DESKeyMask(const std::string& mask) {
+    for (size_t i = 0; i < mask.size(); ++i) {
+      if (mask[i] == '?' && i + 1 < mask.size()) {
+        m_charsets.push_back(charset(mask[++i]));
+      }
+      else {
+        m_charsets.push_back(std::string(1, mask[i]));
+      }
+    }
+    if (m_charsets.empty() || m_charsets.size() > 8) {
+      throw std::invalid_argument("La mascara debe describir entre 1 y 8 caracteres.");
+    }
+  }
+
+  /**
+   * @brief Builds a mask from explicit charsets, one per key position.
+   * @param charsets The characters allowed at each position; repeated
+   *        characters are dropped, keeping the first occurrence.
+   * @throws std::invalid_argument if there are not 1..8 positions or a
+   *         charset is empty or longer than 256 characters.
+   */
+  static DESKeyMask
+  fromCharsets(const std::vector<std::string>& charsets) {
+    if (charsets.empty() || charsets.size() > 8) {
+      throw std::invalid_argument("La mascara debe describir entre 1 y 8 caracteres.");
+    }
+    DESKeyMask m;
+    for (const auto& cs : charsets) {
+      if (cs.empty() || cs.size() > 256) {
+        throw std::invalid_argument("Cada posicion de la mascara necesita entre 1 y 256 caracteres.");
+      }
+      bool seen[256] = {};
+      std::string unique;
+      for (unsigned char c : cs) {
+        if (!seen[c]) {
+          seen[c] = true;
+          unique += static_cast<char>(c);
+        }
+      }
+      m.m_charsets.push_back(unique);
+    }
+    return m;
+  }
+
+  /**
+   * @brief Number of key characters described by the mask.
+   */
+  size_t
+  length() const {
+    return m_charsets.size();
+  }
+
+  /**
+   * @brief Number of candidate keys (saturates at UINT64_MAX).
+   */
+  uint64_t
+  size() const {
+    uint64_t total = 1;
+    for (const auto& cs : m_charsets) {
+      if (total > UINT64_MAX / cs.size()) return UINT64_MAX;
+      total *= cs.size();
+    }
+    return total;
+  }
+
+  /**
+   * @brief Charset allowed at one key position.
+   */
+  const std::string&
+  charsetAt(size_t position) const {
+    return m_charsets[position];
+  }
+
+  /**
+   * @brief Writes the candidate number @p index as mixed-radix digits.
+   * @param index Candidate index in [0, size()).
+   * @param digits Output: one charset index per position (last position varies fastest).
+   */
+  void
+  digitsOf(uint64_t index, std::array<uint8_t, 8>& digits) const {
+    for (size_t p = m_charsets.size(); p-- > 0;) {
+      digits[p] = static_cast<uint8_t>(index % m_charsets[p].size());
+      index /= m_charsets[p].size();
+    }
+  }
+
+  /**
+   * @brief Advances mixed-radix digits to the next candidate.
+   */
+  void
+  increment(std::array<uint8_t, 8>& digits) const {
+    for (size_t p = m_charsets.size(); p-- > 0;) {
+      if (digits[p] + 1u < m_charsets[p].size()) {
+        ++digits[p];
+        return;
+      }
+      digits[p] = 0;
+    }
+  }
+
+  /**
+   * @brief Text of the candidate described by @p digits.
+   */
+  std::string
+  textOf(const std::array<uint8_t, 8>& digits) const {
+    std::string key(m_charsets.size(), '\0');
+    for (size_t p = 0; p < m_charsets.size(); ++p) {
+      key[p] = m_charsets[p][digits[p]];
+    }
+    return key;
+  }
+
+  /**
+   * @brief 64-bit DES key of the candidate, same layout as convertTextKeyToBitset64.
+   */
+  uint64_t
+  keyOf(const std::array<uint8_t, 8>& digits) const {
+    unsigned char bytes[8];
+    for (size_t p = 0; p < m_charsets.size(); ++p) {
+      bytes[p] = static_cast<unsigned char>(m_charsets[p][digits[p]]);
+    }
+    return DES::loadBlock(bytes, m_charsets.size());
+  }
+
+private:
+  static std::string
+  charset(char token) {
+    switch (token) {
+    case 'l': return "abcdefghijklmnopqrstuvwxyz";
+    case 'u': return "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    case 'd': return "0123456789";
+    case 's': return " !\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~";
+    case 'a': {
+      std::string all;
+      for (char c = 32; c < 127; ++c) all += c;
+      return all;
+    }
+    case '?': return "?";
+    default:
+      throw std::invalid_argument(std::string("Token de mascara desconocido: ?") + token);
+    }
+  }
+
+  std::vector<std::string> m_charsets; ///< Allowed characters per key position.
+};
+
+/**
+ * @struct DESKeySearchResult
+ * @brief Outcome of a DESKeySearch run.
+ */
+struct
+DESKeySearchResult {
+  bool found = false;        ///< Whether a matching key was found.
+  std::string key;           ///< Text key that was found.
+  uint64_t keyBits = 0;      ///< The key as a 64-bit word.
+  uint64_t tested = 0;       ///< Candidates tested.
+  double seconds = 0.0;      ///< Wall-clock time.
+  double keysPerSecond = 0.0;///< Average search rate.
+};
+
+/**
+ * @class DESKeySearch
+ * @brief Multithreaded known-plaintext key recovery over a DESKeyMask keyspace.
+ *
+ * With wide (AVX2) slices, candidates are tested BitslicedDES::BLOCKS at a time,
+ * each lane carrying its own key; otherwise a single DESKeyContext is rekeyed
+ * per candidate. Either way no DES object or subkey vector is built per key. The
+ * keyspace is spread over all cores with Parallel::forStealing and the search
+ * stops at the first hit.
+ */
+class
+DESKeySearch {
+public:
+  using Engine = BitslicedDESNative;
+  using Slice = Engine::Slice;
+
+  /// Progress callback: (candidates tested so far, current keys/second).
+  using ProgressFn = std::function<void(uint64_t, double)>;
+
+  /**
+   * @brief Constructs the search for one known block pair.
+   * @param plaintext Known plaintext block (std::bitset<64>::to_ullong() format).
+   * @param ciphertext Matching ciphertext block.
+   * @param threads Worker threads (0 = all cores).
+   */
+  DESKeySearch(uint64_t plaintext, uint64_t ciphertext, unsigned int threads = 0)
+    : m_plaintext(plaintext), m_ciphertext(ciphertext), m_threads(threads) {}
+
+  ~DESKeySearch() = default;
+
+  /**
+   * @brief Searches the keyspace of @p mask.
+   * @param mask The keyspace.
+   * @param progress Optional callback, invoked about once per second.
+   * @return The search result.
+   */
+  DESKeySearchResult
+  run(const DESKeyMask& mask, ProgressFn progress = nullptr) {
+    using Clock = std::chrono::steady_clock;
+
+    // Plaintext and expected ciphertext are the same in every lane
+    Slice plain[64], target[64];
+    for (int b = 0; b < 64; ++b) {
+      plain[b] = ((m_plaintext >> b) & 1) ? Slice::ones() : Slice::zero();
+      target[b] = ((m_ciphertext >> b) & 1) ? Slice::ones() : Slice::zero();
+    }
+
+    std::atomic<uint64_t> tested{ 0 };
+    std::mutex resultMtx;
+    DESKeySearchResult result;
+    auto start = Clock::now();
+
+    ProgressReporter reporter(tested, progress);
+
+    uint64_t grain = Engine::BLOCKS * 64;
+    Parallel::forStealing(mask.size(), m_threads, grain, [&](uint64_t begin, uint64_t end) {
+      Engine engine;
+      uint64_t keys[Engine::BLOCKS];
+      std::array<uint8_t, 8> digits{};
+      mask.digitsOf(begin, digits);
+
+      if (!DESBatch::USE_BITSLICE) {
+        DESKeyContext ctx;
+        for (uint64_t i = begin; i < end; ++i) {
+          ctx.rekey(mask.keyOf(digits));
+          if (ctx.encodeBlock(m_plaintext) == m_ciphertext) {
+            std::lock_guard<std::mutex> lock(resultMtx);
+            if (!result.found) {
+              result.found = true;
+              result.key = mask.textOf(digits);
+              result.keyBits = mask.keyOf(digits);
+            }
+            tested += i - begin + 1;
+            return false;
+          }
+          mask.increment(digits);
+        }
+        tested += end - begin;
+        return true;
+      }
+
+      for (uint64_t i = begin; i < end; i += Engine::BLOCKS) {
+        size_t n = static_cast<size_t>(std::min<uint64_t>(Engine::BLOCKS, end - i));
+        for (size_t j = 0; j < n; ++j) {
+          keys[j] = mask.keyOf(digits);
+          mask.increment(digits);
+        }
+        engine.setKeys(keys, n);
+
+        Slice s[64];
+        std::copy(std::begin(plain), std::end(plain), s);
+        engine.encodeSlices(s);
+
+        Slice diff = Slice::zero();
+        for (int b = 0; b < 64; ++b) {
+          diff |= s[b] ^ target[b];
+        }
+
+        for (size_t w = 0; w < Engine::BLOCKS / 64; ++w) {
+          uint64_t hits = ~diff.get(w);
+          while (hits != 0) {
+            int bit = 0;
+            while (((hits >> bit) & 1) == 0) ++bit;
+            hits &= hits - 1;
+            size_t lane = Engine::blockOfBit(w, bit);
+            if (lane >= n) continue;
+
+            std::lock_guard<std::mutex> lock(resultMtx);
+            if (!result.found) {
+              std::array<uint8_t, 8> hitDigits{};
+              mask.digitsOf(i + lane, hitDigits);
+              result.found = true;
+              result.key = mask.textOf(hitDigits);
+              result.keyBits = keys[lane];
+            }
+            tested += lane + 1;
+            return false;
+          }
+        }
+        tested += n;
+      }
+      return true;
+    });
+
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    reporter.stop();
+
+    result.tested = tested.load();
+    result.keysPerSecond = result.seconds > 0 ? result.tested / result.seconds : 0.0;
+    return result;
+  }
+
+private:
+  uint64_t m_plaintext;   ///< Known plaintext block.
+  uint64_t m_ciphertext;  ///< Known ciphertext block.
+  unsigned int m_threads; ///< Worker threads (0 = all cores).
+};
@@ -0,0 +1,435 @@
+#pragma once
+#include "Prerequisites.h"
+#include "DES.h"
+#include "BitslicedDES.h"
+#include "DESBatch.h"
+#include "DESKeySearch.h"
+#include "Parallel.h"
+
+/**
+ * @struct DESMeetInTheMiddleResult
+ * @brief Outcome of a DESMeetInTheMiddle run.
+ */
+struct
+DESMeetInTheMiddleResult {
+  std::vector<std::pair<std::string, std::string>> keys; ///< Matching (k1, k2) text keys.
+  uint64_t forwardKeys = 0;     ///< k1 candidates encrypted into the table.
+  uint64_t backwardKeys = 0;    ///< k2 decryptions performed (all passes).
+  uint64_t candidates = 0;      ///< Table hits on the stored 40 bits.
+  uint64_t falsePositives = 0;  ///< Hits rejected after recomputing the full block.
+  unsigned int passes = 0;      ///< Backward passes (1 unless the table spilled).
+  bool spilled = false;         ///< Whether the table was written to disk.
+  uint64_t tableBytes = 0;      ///< Size of the forward table.
+  double seconds = 0.0;         ///< Wall-clock time.
+};
+
+/**
+ * @class DESMeetInTheMiddle
+ * @brief Meet-in-the-middle key recovery for DoubleDES over two DESKeyMask keyspaces.
+ *
+ * Forward phase: every k1 of the first mask encrypts the known plaintext and
+ * the middle value goes into one of 256 shards, picked by its top 8 bits.
+ * An entry keeps only the next 32 bits and the index of k1 (8 bytes), so a
+ * table hit matches 40 bits and is confirmed by recomputing E_k1(P).
+ *
+ * Backward phase: every k2 of the second mask decrypts the ciphertext from
+ * several threads and probes the shard of the result. Each shard is
+ * counting-sorted into buckets by the top bits of the tag, with an offset
+ * directory, so a probe reads one short bucket instead of binary searching.
+ *
+ * When the table does not fit in the memory limit, shards are written to
+ * disk while they are built and then loaded a group at a time; the backward
+ * phase is repeated once per group (time traded for memory). Spill files
+ * carry a random per-run tag and are deleted however the run ends.
+ */
+class
+DESMeetInTheMiddle {
+public:
+  using Engine = BitslicedDESNative;
+  using Slice = Engine::Slice;
+
+  /// Number of shards of the forward table.
+  static constexpr size_t SHARDS = 256;
+
+  /// Default memory limit for the forward table: 1 GB.
+  static constexpr uint64_t DEFAULT_MEMORY = 1ull << 30;
+
+  /// Maximum number of key pairs reported.
+  static constexpr size_t MAX_RESULTS = 64;
+
+  /**
+   * @brief Constructs the attack for one known plaintext/ciphertext pair.
+   * @param plaintext Known plaintext block.
+   * @param ciphertext Matching DoubleDES ciphertext block.
+   * @param threads Worker threads (0 = all cores).
+   * @param memoryLimit Bytes the forward table may keep in memory.
+   * @param spillDir Directory for spilled shards (empty = system temp directory).
+   */
+  DESMeetInTheMiddle(uint64_t plaintext,
+                     uint64_t ciphertext,
+                     unsigned int threads = 0,
+                     uint64_t memoryLimit = DEFAULT_MEMORY,
+                     const std::string& spillDir = "")
+    : m_plaintext(plaintext), m_ciphertext(ciphertext), m_threads(threads),
+      m_memoryLimit(std::max<uint64_t>(memoryLimit, sizeof(Entry))), m_spillDir(spillDir) {}
+
+  ~DESMeetInTheMiddle() = default;
+
+  /**
+   * @brief Adds a second known pair to discard keys that only match the first one.
+   */
+  void
+  setVerificationPair(uint64_t plaintext, uint64_t ciphertext) {
+    m_hasSecondPair = true;
+    m_plaintext2 = plaintext;
+    m_ciphertext2 = ciphertext;
+  }
+
+  /**
+   * @brief Runs the attack.
+   * @param firstMask Keyspace of k1 (at most 2^32 keys).
+   * @param secondMask Keyspace of k2.
+   * @return The result; keys holds every pair consistent with the known blocks.
+   * @throws std::invalid_argument if the first keyspace is too large.
+   * @throws std::runtime_error if a spill file cannot be written or read.
+   */
+  DESMeetInTheMiddleResult
+  run(const DESKeyMask& firstMask, const DESKeyMask& secondMask) {
+    using Clock = std::chrono::steady_clock;
+    if (firstMask.size() > UINT32_MAX) {
+      throw std::invalid_argument("El espacio de k1 no puede superar 2^32 claves.");
+    }
+
+    auto start = Clock::now();
+    DESMeetInTheMiddleResult result;
+    result.forwardKeys = firstMask.size();
+    result.tableBytes = firstMask.size() * sizeof(Entry);
+    result.spilled = result.tableBytes > m_memoryLimit;
+
+    // About 4 entries per bucket
+    m_bucketBits = 0;
+    while (m_bucketBits < 20 && (firstMask.size() / SHARDS >> (m_bucketBits + 2)) > 0) ++m_bucketBits;
+
+    // Spill files are deleted on every exit, also when one cannot be written or read
+    struct
+    SpillCleanup {
+      const DESMeetInTheMiddle* attack;
+      bool active;
+
+      ~SpillCleanup() {
+        if (active) attack->removeSpillFiles();
+      }
+    };
+    if (result.spilled) m_spillTag = newSpillTag();
+    SpillCleanup cleanup{ this, result.spilled };
+
+    std::vector<Shard> shards(SHARDS);
+    std::vector<uint64_t> counts(SHARDS, 0);
+    buildForward(firstMask, result.spilled, shards, counts);
+
+    // Groups of consecutive shards that fit in memory together
+    size_t first = 0;
+    while (first < SHARDS) {
+      size_t last = first;
+      uint64_t bytes = counts[first] * sizeof(Entry);
+      while (last + 1 < SHARDS && bytes + counts[last + 1] * sizeof(Entry) <= m_memoryLimit) {
+        bytes += counts[++last] * sizeof(Entry);
+      }
+
+      if (result.spilled) loadShards(shards, first, last);
+      Parallel::forRange(last - first + 1, m_threads, 1, [&](size_t begin, size_t end) {
+        for (size_t s = first + begin; s < first + end; ++s) {
+          bucketize(shards[s]);
+        }
+      });
+
+      probeBackward(firstMask, secondMask, shards, first, last, result);
+      ++result.passes;
+
+      if (result.spilled) {
+        for (size_t s = first; s <= last; ++s) {
+          shards[s] = Shard();
+        }
+      }
+      first = last + 1;
+    }
+
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return result;
+  }
+
+private:
+  /**
+   * @brief Forward table entry: bits 55..24 of the middle value and the k1 index.
+   */
+  struct
+  Entry {
+    uint32_t tag;
+    uint32_t keyIndex;
+  };
+
+  /**
+   * @brief One shard: entries grouped by bucket plus the bucket offsets.
+   */
+  struct
+  Shard {
+    std::vector<Entry> entries;
+    std::vector<uint32_t> offsets; ///< Bucket b is entries[offsets[b], offsets[b + 1]).
+  };
+
+  static size_t
+  shardOf(uint64_t middle) {
+    return static_cast<size_t>(middle >> 56);
+  }
+
+  static uint32_t
+  tagOf(uint64_t middle) {
+    return static_cast<uint32_t>(middle >> 24);
+  }
+
+  size_t
+  bucketOf(uint32_t tag) const {
+    return m_bucketBits == 0 ? 0 : tag >> (32 - m_bucketBits);
+  }
+
+  /**
+   * @brief Counting sort of a shard's entries by bucket; builds the offsets.
+   */
+  void
+  bucketize(Shard& shard) const {
+    size_t buckets = size_t(1) << m_bucketBits;
+    shard.offsets.assign(buckets + 1, 0);
+    for (const Entry& e : shard.entries) {
+      ++shard.offsets[bucketOf(e.tag) + 1];
+    }
+    for (size_t b = 0; b < buckets; ++b) {
+      shard.offsets[b + 1] += shard.offsets[b];
+    }
+
+    std::vector<Entry> sorted(shard.entries.size());
+    std::vector<uint32_t> next(shard.offsets.begin(), shard.offsets.end() - 1);
+    for (const Entry& e : shard.entries) {
+      sorted[next[bucketOf(e.tag)]++] = e;
+    }
+    shard.entries.swap(sorted);
+  }
+
+  std::string
+  spillPath(size_t shard) const {
+    std::filesystem::path dir = m_spillDir.empty()
+      ? std::filesystem::temp_directory_path() : std::filesystem::path(m_spillDir);
+    return (dir / ("mitm_" + m_spillTag + "_shard_" + std::to_string(shard) + ".bin")).string();
+  }
+
+  /**
+   * @brief Random tag that keeps apart the spill files of concurrent runs and of leftovers.
+   */
+  static std::string
+  newSpillTag() {
+    std::random_device device;
+    uint64_t tag = (static_cast<uint64_t>(device()) << 32) ^ device() ^
+      static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    std::ostringstream out;
+    out << std::hex << std::setw(16) << std::setfill('0') << tag;
+    return out.str();
+  }
+
+  /**
+   * @brief Runs one block through DES under every key of @p mask, in parallel.
+   * @param makeWorker Called once per thread; the returned callable is invoked as
+   *        worker(firstIndex, keys, outputs, count) for each batch of keys.
+   */
+  template<typename Factory>
+  void
+  sweep(const DESKeyMask& mask, uint64_t block, bool decrypt, Factory&& makeWorker) const {
+    Slice input[64];
+    for (int b = 0; b < 64; ++b) {
+      input[b] = ((block >> b) & 1) ? Slice::ones() : Slice::zero();
+    }
+
+    Parallel::forRange(mask.size(), m_threads, Engine::BLOCKS * 16, [&](size_t begin, size_t end) {
+      auto worker = makeWorker();
+      Engine engine;
+      DESKeyContext ctx;
+      uint64_t keys[Engine::BLOCKS];
+      uint64_t out[Engine::BLOCKS];
+      std::array<uint8_t, 8> digits{};
+      mask.digitsOf(begin, digits);
+
+      for (size_t i = begin; i < end; i += Engine::BLOCKS) {
+        size_t n = std::min(Engine::BLOCKS, end - i);
+        for (size_t j = 0; j < n; ++j) {
+          keys[j] = mask.keyOf(digits);
+          mask.increment(digits);
+        }
+
+        if (DESBatch::USE_BITSLICE) {
+          engine.setKeys(keys, n);
+          Slice s[64];
+          std::copy(std::begin(input), std::end(input), s);
+          if (decrypt) engine.decodeSlices(s);
+          else engine.encodeSlices(s);
+          Engine::storeSlices(s, out, n);
+        }
+        else {
+          for (size_t j = 0; j < n; ++j) {
+            ctx.rekey(keys[j]);
+            out[j] = decrypt ? ctx.decodeBlock(block) : ctx.encodeBlock(block);
+          }
+        }
+        worker(i, keys, out, n);
+      }
+    });
+  }
+
+  /**
+   * @brief Builds the forward table, in memory or in spill files.
+   *
+   * Workers collect entries in small per-shard buffers and flush them under
+   * the shard's lock, so threads rarely contend.
+   */
+  void
+  buildForward(const DESKeyMask& mask, bool spill,
+               std::vector<Shard>& shards, std::vector<uint64_t>& counts) {
+    static constexpr size_t FLUSH = 512;
+    std::vector<std::mutex> locks(SHARDS);
+    std::vector<std::ofstream> files;
+    if (spill) {
+      for (size_t s = 0; s < SHARDS; ++s) {
+        files.emplace_back(spillPath(s), std::ios::binary | std::ios::trunc);
+        if (!files.back()) throw std::runtime_error("Error al crear el archivo: " + spillPath(s));
+      }
+    }
+    else {
+      uint64_t expected = mask.size() / SHARDS;
+      for (auto& shard : shards) shard.entries.reserve(expected + expected / 8 + 16);
+    }
+
+    auto flush = [&](size_t s, std::vector<Entry>& buffer) {
+      std::lock_guard<std::mutex> lock(locks[s]);
+      if (spill) {
+        files[s].write(reinterpret_cast<const char*>(buffer.data()),
+                       static_cast<std::streamsize>(buffer.size() * sizeof(Entry)));
+      }
+      else {
+        shards[s].entries.insert(shards[s].entries.end(), buffer.begin(), buffer.end());
+      }
+      counts[s] += buffer.size();
+      buffer.clear();
+    };
+
+    // Per-thread buffers; whatever is left is flushed when the worker ends
+    struct
+    Buffers {
+      std::function<void(size_t, std::vector<Entry>&)>* flush;
+      std::vector<std::vector<Entry>> perShard = std::vector<std::vector<Entry>>(SHARDS);
+
+      void
+      operator()(size_t first, const uint64_t*, const uint64_t* out, size_t n) {
+        for (size_t j = 0; j < n; ++j) {
+          size_t s = shardOf(out[j]);
+          perShard[s].push_back({ tagOf(out[j]), static_cast<uint32_t>(first + j) });
+          if (perShard[s].size() == FLUSH) (*flush)(s, perShard[s]);
+        }
+      }
+
+      ~Buffers() {
+        for (size_t s = 0; s < SHARDS; ++s) {
+          if (!perShard[s].empty()) (*flush)(s, perShard[s]);
+        }
+      }
+    };
+
+    std::function<void(size_t, std::vector<Entry>&)> flushFn = flush;
+    sweep(mask, m_plaintext, false, [&]() { return Buffers{ &flushFn }; });
+
+    for (auto& file : files) {
+      if (!file.flush()) throw std::runtime_error("Error al escribir la tabla en disco.");
+    }
+  }
+
+  void
+  loadShards(std::vector<Shard>& shards, size_t first, size_t last) const {
+    for (size_t s = first; s <= last; ++s) {
+      std::ifstream in(spillPath(s), std::ios::binary | std::ios::ate);
+      if (!in) throw std::runtime_error("Error al abrir el archivo: " + spillPath(s));
+      size_t bytes = static_cast<size_t>(in.tellg());
+      shards[s].entries.resize(bytes / sizeof(Entry));
+      in.seekg(0);
+      in.read(reinterpret_cast<char*>(shards[s].entries.data()), static_cast<std::streamsize>(bytes));
+    }
+  }
+
+  void
+  removeSpillFiles() const {
+    for (size_t s = 0; s < SHARDS; ++s) {
+      std::error_code ec;
+      std::filesystem::remove(spillPath(s), ec);
+    }
+  }
+
+  /**
+   * @brief Decrypts the ciphertext under every k2 and probes shards [first, last].
+   */
+  void
+  probeBackward(const DESKeyMask& firstMask, const DESKeyMask& secondMask,
+                const std::vector<Shard>& shards, size_t first, size_t last,
+                DESMeetInTheMiddleResult& result) {
+    std::atomic<uint64_t> candidates{ 0 };
+    std::atomic<uint64_t> falsePositives{ 0 };
+    std::mutex resultMtx;
+
+    sweep(secondMask, m_ciphertext, true, [&]() {
+      return [&, inner = DESKeyContext(), outer = DESKeyContext()]
+        (size_t, const uint64_t* keys, const uint64_t* out, size_t n) mutable {
+        for (size_t j = 0; j < n; ++j) {
+          size_t s = shardOf(out[j]);
+          if (s < first || s > last) continue;
+
+          uint32_t tag = tagOf(out[j]);
+          size_t bucket = bucketOf(tag);
+          const Entry* begin = shards[s].entries.data() + shards[s].offsets[bucket];
+          const Entry* end = shards[s].entries.data() + shards[s].offsets[bucket + 1];
+          for (const Entry* it = begin; it != end; ++it) {
+            if (it->tag != tag) continue;
+            ++candidates;
+            std::array<uint8_t, 8> digits{};
+            firstMask.digitsOf(it->keyIndex, digits);
+            inner.rekey(firstMask.keyOf(digits));
+            if (inner.encodeBlock(m_plaintext) != out[j]) {
+              ++falsePositives;
+              continue;
+            }
+            if (m_hasSecondPair) {
+              outer.rekey(keys[j]);
+              if (outer.encodeBlock(inner.encodeBlock(m_plaintext2)) != m_ciphertext2) continue;
+            }
+
+            std::lock_guard<std::mutex> lock(resultMtx);
+            if (result.keys.size() < MAX_RESULTS) {
+              unsigned char bytes[8];
+              DES::storeBlock(keys[j], bytes);
+              std::string k2(reinterpret_cast<const char*>(bytes), secondMask.length());
+              result.keys.emplace_back(firstMask.textOf(digits), k2);
+            }
+          }
+        }
+      };
+    });
+
+    result.backwardKeys += secondMask.size();
+    result.candidates += candidates.load();
+    result.falsePositives += falsePositives.load();
+  }
+
+  uint64_t m_plaintext;          ///< Known plaintext block.
+  uint64_t m_ciphertext;         ///< Known ciphertext block.
+  unsigned int m_threads;        ///< Worker threads (0 = all cores).
+  uint64_t m_memoryLimit;        ///< Bytes the forward table may keep in memory.
+  std::string m_spillDir;        ///< Directory for spilled shards.
+  std::string m_spillTag;        ///< Per-run part of the spill file names.
+  bool m_hasSecondPair = false;  ///< Whether a verification pair was given.
+  uint64_t m_plaintext2 = 0;     ///< Second known plaintext block.
+  uint64_t m_ciphertext2 = 0;    ///< Second known ciphertext block.
+  unsigned int m_bucketBits = 0; ///< Tag bits used as bucket index within a shard.
+};
@@ -0,0 +1,297 @@
+#pragma once
+#include "Prerequisites.h"
+#include "DESBatch.h"
+#include "Parallel.h"
+
+/**
+ * @brief Block cipher modes supported by BlockModeCipher.
+ */
+enum class DESMode {
+  ECB, ///< Each block on its own; zero padding (legacy format of option 6).
+  CBC, ///< Cipher block chaining with PKCS#7 padding.
+  CTR, ///< Counter mode (IV + block index); no padding.
+  OFB  ///< Output feedback; no padding.
+};
+
+/**
+ * @class BlockModeCipher
+ * @brief Block mode layer over a 64-bit block cipher for whole buffers or chunked streams.
+ *
+ * @tparam Cipher Multi-block primitive with BATCH, encode/decode(in, out, count)
+ *         and encodeBlock/decodeBlock(uint64_t), e.g. DESBatch or TripleDES.
+ *
+ * Independent blocks (ECB, CTR keystream and CBC decryption) are split across
+ * worker threads and pushed through the primitive in batches. CBC encryption
+ * and OFB are inherently sequential and go one block at a time.
+ *
+ * For chunked use, call begin() with the IV and then encryptChunk() /
+ * decryptChunk() in order; every chunk except the last must be a multiple
+ * of 8 bytes. The output buffer needs room for @p bytes + 8 and must not
+ * overlap the input.
+ */
+template<typename Cipher>
+class
+BlockModeCipher {
+public:
+  /**
+   * @brief Constructs the mode cipher.
+   * @param cipher The keyed primitive (a DES key converts to DESBatch implicitly).
+   * @param mode Block mode.
+   * @param threads Worker threads for the parallel paths (0 = all cores).
+   */
+  BlockModeCipher(const Cipher& cipher, DESMode mode, unsigned int threads = 0)
+    : m_batch(cipher), m_mode(mode), m_threads(threads) {}
+
+  ~BlockModeCipher() = default;
+
+  /**
+   * @brief Whether the mode needs an IV (every mode except ECB).
+   */
+  bool
+  usesIV() const {
+    return m_mode != DESMode::ECB;
+  }
+
+  /**
+   * @brief Encrypts a whole buffer.
+   * @param plain The plaintext.
+   * @param iv 8-byte IV, e.g. from CryptoGenerator::generateIV(8); ignored in ECB.
+   * @return The IV (except in ECB) followed by the ciphertext.
+   * @throws std::invalid_argument if the IV is not 8 bytes long.
+   */
+  std::string
+  encrypt(const std::string& plain, const std::vector<uint8_t>& iv) {
+    uint64_t ivBlock = 0;
+    std::string result;
+    if (usesIV()) {
+      if (iv.size() != 8) throw std::invalid_argument("El IV debe tener 8 bytes.");
+      ivBlock = DES::loadBlock(iv.data());
+      result.assign(iv.begin(), iv.end());
+    }
+
+    size_t header = result.size();
+    result.resize(header + plain.size() + 8);
+    begin(ivBlock);
+    size_t produced = encryptChunk(reinterpret_cast<const unsigned char*>(plain.data()),
+                                   reinterpret_cast<unsigned char*>(&result[header]),
+                                   plain.size(), true);
+    result.resize(header + produced);
+    return result;
+  }
+
+  /**
+   * @brief Decrypts a buffer produced by encrypt().
+   * @param data The IV (except in ECB) followed by the ciphertext.
+   * @return The plaintext.
+   * @throws std::invalid_argument if the data is truncated or the padding is invalid.
+   */
+  std::string
+  decrypt(const std::string& data) {
+    size_t header = usesIV() ? 8 : 0;
+    if (data.size() < header) throw std::invalid_argument("Falta el IV del mensaje cifrado.");
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data.data());
+
+    begin(header ? DES::loadBlock(bytes) : 0);
+    std::string result(data.size() - header + 8, '\0');
+    size_t produced = decryptChunk(bytes + header, reinterpret_cast<unsigned char*>(&result[0]),
+                                   data.size() - header, true);
+    result.resize(produced);
+    return result;
+  }
+
+  /**
+   * @brief Starts a new message.
+   * @param iv The IV as a 64-bit block (ignored in ECB).
+   */
+  void
+  begin(uint64_t iv) {
+    m_chain = iv;
+    m_blockIndex = 0;
+  }
+
+  /**
+   * @brief Encrypts the next chunk of a message.
+   * @param in Plaintext bytes.
+   * @param out Output buffer, at least @p bytes + 8 bytes.
+   * @param bytes Number of input bytes (a multiple of 8 unless @p final).
+   * @param final Whether this is the last chunk (padding is added in ECB/CBC).
+   * @return Number of bytes written to @p out.
+   */
+  size_t
+  encryptChunk(const unsigned char* in, unsigned char* out, size_t bytes, bool final) {
+    switch (m_mode) {
+    case DESMode::ECB:
+      return parallelBlocks(in, out, bytes, false);
+    case DESMode::CBC: {
+      size_t full = bytes / 8;
+      for (size_t i = 0; i < full; ++i) {
+        m_chain = m_batch.encodeBlock(DES::loadBlock(in + i * 8) ^ m_chain);
+        DES::storeBlock(m_chain, out + i * 8);
+      }
+      if (!final) return full * 8;
+
+      // PKCS#7: always pad, with 1 to 8 bytes of value n
+      unsigned char last[8];
+      size_t rest = bytes - full * 8;
+      unsigned char pad = static_cast<unsigned char>(8 - rest);
+      for (size_t b = 0; b < 8; ++b) {
+        last[b] = b < rest ? in[full * 8 + b] : pad;
+      }
+      m_chain = m_batch.encodeBlock(DES::loadBlock(last) ^ m_chain);
+      DES::storeBlock(m_chain, out + full * 8);
+      return full * 8 + 8;
+    }
+    case DESMode::CTR:
+      return counterKeystream(in, out, bytes);
+    case DESMode::OFB:
+    default:
+      return outputFeedback(in, out, bytes);
+    }
+  }
+
+  /**
+   * @brief Decrypts the next chunk of a message.
+   * @param in Ciphertext bytes.
+   * @param out Output buffer, at least @p bytes bytes.
+   * @param bytes Number of input bytes (a multiple of 8 in ECB and CBC).
+   * @param final Whether this is the last chunk (CBC padding is removed).
+   * @return Number of bytes written to @p out.
+   * @throws std::invalid_argument on a truncated block or invalid padding.
+   */
+  size_t
+  decryptChunk(const unsigned char* in, unsigned char* out, size_t bytes, bool final) {
+    switch (m_mode) {
+    case DESMode::ECB:
+      if (bytes % 8 != 0) {
+        throw std::invalid_argument("El texto cifrado en modo ECB no es m\u00faltiplo de 8 bytes.");
+      }
+      return parallelBlocks(in, out, bytes, true);
+    case DESMode::CBC: {
+      if (bytes % 8 != 0) {
+        throw std::invalid_argument("El texto cifrado en modo CBC no es m\u00faltiplo de 8 bytes.");
+      }
+      uint64_t previous = m_chain;
+      size_t produced = parallelBlocks(in, out, bytes, true);
+      // P_i = D(C_i) ^ C_{i-1}; every block only needs the ciphertext before it
+      Parallel::forRange(bytes / 8, m_threads, 4096, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          uint64_t chain = i == 0 ? previous : DES::loadBlock(in + (i - 1) * 8);
+          DES::storeBlock(DES::loadBlock(out + i * 8) ^ chain, out + i * 8);
+        }
+      });
+      if (bytes > 0) m_chain = DES::loadBlock(in + bytes - 8);
+      m_blockIndex += bytes / 8;
+      return final ? produced - checkPadding(out, produced) : produced;
+    }
+    case DESMode::CTR:
+      return counterKeystream(in, out, bytes);
+    case DESMode::OFB:
+    default:
+      return outputFeedback(in, out, bytes);
+    }
+  }
+
+private:
+  /**
+   * @brief Validates PKCS#7 padding at the end of @p data.
+   * @return Number of padding bytes.
+   */
+  static size_t
+  checkPadding(const unsigned char* data, size_t size) {
+    if (size == 0) throw std::invalid_argument("Relleno PKCS#7 inv\u00e1lido.");
+    unsigned char pad = data[size - 1];
+    if (pad == 0 || pad > 8 || pad > size) throw std::invalid_argument("Relleno PKCS#7 inv\u00e1lido.");
+    for (size_t i = size - pad; i < size; ++i) {
+      if (data[i] != pad) throw std::invalid_argument("Relleno PKCS#7 inv\u00e1lido.");
+    }
+    return pad;
+  }
+
+  /**
+   * @brief ECB encryption/decryption (also the block step of CBC decryption).
+   *
+   * A partial last block is zero padded, as option 6 always did.
+   */
+  size_t
+  parallelBlocks(const unsigned char* in, unsigned char* out, size_t bytes, bool decrypt) {
+    size_t blocks = (bytes + 7) / 8;
+    Parallel::forRange(blocks, m_threads, Cipher::BATCH, [&](size_t begin, size_t end) {
+      uint64_t buf[Cipher::BATCH];
+      for (size_t i = begin; i < end; i += Cipher::BATCH) {
+        size_t n = std::min(Cipher::BATCH, end - i);
+        for (size_t j = 0; j < n; ++j) {
+          size_t offset = (i + j) * 8;
+          buf[j] = DES::loadBlock(in + offset, std::min<size_t>(8, bytes - offset));
+        }
+        if (decrypt) m_batch.decode(buf, buf, n);
+        else m_batch.encode(buf, buf, n);
+        for (size_t j = 0; j < n; ++j) {
+          DES::storeBlock(buf[j], out + (i + j) * 8);
+        }
+      }
+    });
+    return blocks * 8;
+  }
+
+  /**
+   * @brief CTR: XOR with E(IV + block index), generated in parallel batches.
+   */
+  size_t
+  counterKeystream(const unsigned char* in, unsigned char* out, size_t bytes) {
+    size_t blocks = (bytes + 7) / 8;
+    uint64_t first = m_chain + m_blockIndex;
+    Parallel::forRange(blocks, m_threads, Cipher::BATCH, [&](size_t begin, size_t end) {
+      uint64_t buf[Cipher::BATCH];
+      for (size_t i = begin; i < end; i += Cipher::BATCH) {
+        size_t n = std::min(Cipher::BATCH, end - i);
+        for (size_t j = 0; j < n; ++j) {
+          buf[j] = first + i + j;
+        }
+        m_batch.encode(buf, buf, n);
+        xorKeystream(in, out, bytes, i, n, buf);
+      }
+    });
+    m_blockIndex += blocks;
+    return bytes;
+  }
+
+  /**
+   * @brief OFB: the register is encrypted again for every block (sequential).
+   */
+  size_t
+  outputFeedback(const unsigned char* in, unsigned char* out, size_t bytes) {
+    uint64_t buf[Cipher::BATCH];
+    size_t blocks = (bytes + 7) / 8;
+    for (size_t i = 0; i < blocks; i += Cipher::BATCH) {
+      size_t n = std::min(Cipher::BATCH, blocks - i);
+      for (size_t j = 0; j < n; ++j) {
+        m_chain = m_batch.encodeBlock(m_chain);
+        buf[j] = m_chain;
+      }
+      xorKeystream(in, out, bytes, i, n, buf);
+    }
+    m_blockIndex += blocks;
+    return bytes;
+  }
+
+  static void
+  xorKeystream(const unsigned char* in, unsigned char* out, size_t bytes,
+               size_t firstBlock, size_t count, const uint64_t* keystream) {
+    for (size_t j = 0; j < count; ++j) {
+      size_t offset = (firstBlock + j) * 8;
+      size_t len = std::min<size_t>(8, bytes - offset);
+      for (size_t b = 0; b < len; ++b) {
+        out[offset + b] = in[offset + b] ^ static_cast<unsigned char>(keystream[j] >> ((7 - b) * 8));
+      }
+    }
+  }
+
+  Cipher m_batch;               ///< Multi-block primitive.
+  DESMode m_mode;               ///< Block mode.
+  unsigned int m_threads;       ///< Worker threads (0 = all cores).
+  uint64_t m_chain = 0;         ///< IV / previous ciphertext (CBC) / feedback register (OFB).
+  uint64_t m_blockIndex = 0;    ///< Blocks processed since begin().
+};
+
+/// Block modes over single DES.
+using DESModeCipher = BlockModeCipher<DESBatch>;
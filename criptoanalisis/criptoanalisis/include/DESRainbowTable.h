@@ -0,0 +1,340 @@
+#pragma once
+#include "Prerequisites.h"
+#include "DES.h"
+#include "BitslicedDES.h"
+#include "DESBatch.h"
+#include "DESKeySearch.h"
+#include "MappedFile.h"
+#include "Parallel.h"
+
+/**
+ * @class DESRainbowTable
+ * @brief Rainbow tables for DES keys derived from short text passwords.
+ *
+ * Keys are the candidates of a DESKeyMask, numbered 0..size()-1. A chain
+ * starts at a candidate index x0 and alternates
+ *   c_j = E_key(x_j)(P),   x_{j+1} = R_j(c_j)
+ * for a fixed chosen plaintext P, where R_j hashes the ciphertext back to an
+ * index with a different function per column. Only (end, start) is stored.
+ *
+ * File layout (host byte order):
+ *  - "DESRBOW1", plaintext (u64), chain count (u64), chain length (u32),
+ *    number of key positions (u32), then per position its charset length
+ *    (u8) and characters;
+ *  - zero padding to a multiple of 16 bytes;
+ *  - chains as { end, start } pairs of u64, sorted by end, with no repeated end.
+ *
+ * Lookups map the file and binary search the chains, so only the pages that
+ * are touched are ever read from disk.
+ */
+class
+DESRainbowTable {
+public:
+  using Engine = BitslicedDESNative;
+  using Slice = Engine::Slice;
+
+  /**
+   * @brief Stored chain.
+   */
+  struct
+  Chain {
+    uint64_t end;
+    uint64_t start;
+  };
+
+  /**
+   * @brief Generates a table and writes it to @p path.
+   *
+   * Chains are computed in parallel; with wide (AVX2) slices BitslicedDES
+   * advances Engine::BLOCKS chains per step, each lane with its own key.
+   * @param path Output file (truncated).
+   * @param mask Keyspace (every position needs 1 to 255 characters).
+   * @param plaintext Chosen plaintext block P.
+   * @param chainCount Number of chains to compute (before removing merged ones).
+   * @param chainLength Keys per chain.
+   * @param threads Worker threads (0 = all cores).
+   * @return Number of chains written.
+   * @throws std::invalid_argument on invalid parameters.
+   * @throws std::runtime_error if the file cannot be written.
+   */
+  static uint64_t
+  generate(const std::string& path,
+           const DESKeyMask& mask,
+           uint64_t plaintext,
+           uint64_t chainCount,
+           uint32_t chainLength,
+           unsigned int threads = 0) {
+    if (chainCount == 0 || chainLength == 0) {
+      throw std::invalid_argument("La tabla necesita al menos una cadena de longitud 1.");
+    }
+    for (size_t p = 0; p < mask.length(); ++p) {
+      if (mask.charsetAt(p).size() > 255) {
+        throw std::invalid_argument("Cada posicion admite como maximo 255 caracteres.");
+      }
+    }
+
+    uint64_t space = mask.size();
+    std::vector<Chain> chains(static_cast<size_t>(chainCount));
+    Parallel::forRange(chains.size(), threads, Engine::BLOCKS, [&](size_t begin, size_t end) {
+      Slice plain[64];
+      for (int b = 0; b < 64; ++b) {
+        plain[b] = ((plaintext >> b) & 1) ? Slice::ones() : Slice::zero();
+      }
+      Engine engine;
+      DESKeyContext ctx;
+      uint64_t x[Engine::BLOCKS];
+      uint64_t keys[Engine::BLOCKS];
+      uint64_t cipher[Engine::BLOCKS];
+
+      for (size_t i = begin; i < end; i += Engine::BLOCKS) {
+        size_t n = std::min(Engine::BLOCKS, end - i);
+        for (size_t j = 0; j < n; ++j) {
+          x[j] = mix(i + j) % space;
+          chains[i + j].start = x[j];
+        }
+
+        for (uint32_t col = 0; col < chainLength; ++col) {
+          for (size_t j = 0; j < n; ++j) {
+            keys[j] = keyOfIndex(mask, x[j]);
+          }
+          if (DESBatch::USE_BITSLICE) {
+            engine.setKeys(keys, n);
+            Slice s[64];
+            std::copy(std::begin(plain), std::end(plain), s);
+            engine.encodeSlices(s);
+            Engine::storeSlices(s, cipher, n);
+          }
+          else {
+            for (size_t j = 0; j < n; ++j) {
+              ctx.rekey(keys[j]);
+              cipher[j] = ctx.encodeBlock(plaintext);
+            }
+          }
+          for (size_t j = 0; j < n; ++j) {
+            x[j] = reduce(cipher[j], col, space);
+          }
+        }
+
+        for (size_t j = 0; j < n; ++j) {
+          chains[i + j].end = x[j];
+        }
+      }
+    });
+
+    // Sort by end and keep one chain per end: merged chains add no coverage
+    std::sort(chains.begin(), chains.end(), [](const Chain& a, const Chain& b) {
+      return a.end < b.end;
+    });
+    chains.erase(std::unique(chains.begin(), chains.end(), [](const Chain& a, const Chain& b) {
+      return a.end == b.end;
+    }), chains.end());
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("Error al guardar el archivo: " + path);
+
+    std::string header(MAGIC, 8);
+    appendValue(header, plaintext);
+    appendValue(header, static_cast<uint64_t>(chains.size()));
+    appendValue(header, chainLength);
+    appendValue(header, static_cast<uint32_t>(mask.length()));
+    for (size_t p = 0; p < mask.length(); ++p) {
+      header += static_cast<char>(mask.charsetAt(p).size());
+      header += mask.charsetAt(p);
+    }
+    header.resize((header.size() + 15) & ~size_t(15), '\0');
+
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    out.write(reinterpret_cast<const char*>(chains.data()),
+              static_cast<std::streamsize>(chains.size() * sizeof(Chain)));
+    if (!out) throw std::runtime_error("Error al guardar el archivo: " + path);
+    return chains.size();
+  }
+
+  /**
+   * @brief Opens a table written by generate(); the chains stay on disk.
+   * @param path The table file.
+   * @throws std::runtime_error if the file cannot be mapped or is not a valid table.
+   */
+  explicit DESRainbowTable(const std::string& path)
+    : m_file(path) {
+    const unsigned char* data = m_file.data();
+    size_t size = m_file.size();
+    if (size < 32 || std::memcmp(data, MAGIC, 8) != 0) {
+      throw std::runtime_error("No es una tabla rainbow DES: " + path);
+    }
+
+    size_t offset = 8;
+    m_plaintext = readValue<uint64_t>(data, offset);
+    m_chainCount = readValue<uint64_t>(data, offset);
+    m_chainLength = readValue<uint32_t>(data, offset);
+    uint32_t positions = readValue<uint32_t>(data, offset);
+
+    std::vector<std::string> charsets;
+    for (uint32_t p = 0; p < positions; ++p) {
+      if (offset >= size) throw std::runtime_error("Tabla rainbow truncada: " + path);
+      size_t len = data[offset++];
+      if (offset + len > size) throw std::runtime_error("Tabla rainbow truncada: " + path);
+      charsets.emplace_back(reinterpret_cast<const char*>(data + offset), len);
+      offset += len;
+    }
+    m_mask = DESKeyMask::fromCharsets(charsets);
+
+    offset = (offset + 15) & ~size_t(15);
+    if (offset + m_chainCount * sizeof(Chain) > size) {
+      throw std::runtime_error("Tabla rainbow truncada: " + path);
+    }
+    m_chains = reinterpret_cast<const Chain*>(data + offset);
+  }
+
+  ~DESRainbowTable() = default;
+
+  /**
+   * @brief The keyspace covered by the table.
+   */
+  const DESKeyMask&
+  mask() const {
+    return m_mask;
+  }
+
+  /**
+   * @brief The chosen plaintext the lookups assume.
+   */
+  uint64_t
+  plaintext() const {
+    return m_plaintext;
+  }
+
+  uint64_t
+  chainCount() const {
+    return m_chainCount;
+  }
+
+  uint32_t
+  chainLength() const {
+    return m_chainLength;
+  }
+
+  /**
+   * @brief Looks up the key that encrypts plaintext() into @p ciphertext.
+   *
+   * Every column is tried as the possible position of the key, the shortest
+   * walks first, spread over the cores; the search stops at the first
+   * verified key.
+   * @param ciphertext E_key(plaintext()).
+   * @param threads Worker threads (0 = all cores).
+   * @return found/key/keyBits, plus tested = DES encryptions and the time spent.
+   */
+  DESKeySearchResult
+  lookup(uint64_t ciphertext, unsigned int threads = 0) const {
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    uint64_t space = m_mask.size();
+    std::atomic<uint64_t> tested{ 0 };
+    std::mutex resultMtx;
+    DESKeySearchResult result;
+
+    Parallel::forStealing(m_chainLength, threads, 1, [&](uint64_t begin, uint64_t end) {
+      DESKeyContext ctx;
+      uint64_t work = 0;
+      for (uint64_t k = begin; k < end; ++k) {
+        uint32_t col = static_cast<uint32_t>(m_chainLength - 1 - k);
+
+        // Walk from column col to the end of the chain
+        uint64_t x = reduce(ciphertext, col, space);
+        for (uint32_t j = col + 1; j < m_chainLength; ++j) {
+          ctx.rekey(keyOfIndex(m_mask, x));
+          x = reduce(ctx.encodeBlock(m_plaintext), j, space);
+          ++work;
+        }
+
+        const Chain* first = m_chains;
+        const Chain* last = m_chains + m_chainCount;
+        const Chain* it = std::lower_bound(first, last, x, [](const Chain& c, uint64_t value) {
+          return c.end < value;
+        });
+        if (it == last || it->end != x) continue;
+
+        // Rebuild the chain up to column col and check the key (false alarms are common)
+        uint64_t y = it->start;
+        for (uint32_t j = 0; j < col; ++j) {
+          ctx.rekey(keyOfIndex(m_mask, y));
+          y = reduce(ctx.encodeBlock(m_plaintext), j, space);
+          ++work;
+        }
+        uint64_t key = keyOfIndex(m_mask, y);
+        ctx.rekey(key);
+        ++work;
+        if (ctx.encodeBlock(m_plaintext) == ciphertext) {
+          std::lock_guard<std::mutex> lock(resultMtx);
+          if (!result.found) {
+            std::array<uint8_t, 8> digits{};
+            m_mask.digitsOf(y, digits);
+            result.found = true;
+            result.key = m_mask.textOf(digits);
+            result.keyBits = key;
+          }
+          tested += work;
+          return false;
+        }
+      }
+      tested += work;
+      return true;
+    });
+
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.tested = tested.load();
+    result.keysPerSecond = result.seconds > 0 ? result.tested / result.seconds : 0.0;
+    return result;
+  }
+
+private:
+  static constexpr const char* MAGIC = "DESRBOW1";
+
+  /**
+   * @brief splitmix64 finalizer.
+   */
+  static uint64_t
+  mix(uint64_t v) {
+    v += 0x9E3779B97F4A7C15ULL;
+    v = (v ^ (v >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    v = (v ^ (v >> 27)) * 0x94D049BB133111EBULL;
+    return v ^ (v >> 31);
+  }
+
+  /**
+   * @brief Reduction function of column @p col: ciphertext to candidate index.
+   */
+  static uint64_t
+  reduce(uint64_t cipher, uint32_t col, uint64_t space) {
+    return mix(cipher ^ (static_cast<uint64_t>(col) * 0xD6E8FEB86659FD93ULL)) % space;
+  }
+
+  static uint64_t
+  keyOfIndex(const DESKeyMask& mask, uint64_t index) {
+    std::array<uint8_t, 8> digits{};
+    mask.digitsOf(index, digits);
+    return mask.keyOf(digits);
+  }
+
+  template<typename T>
+  static void
+  appendValue(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template<typename T>
+  static T
+  readValue(const unsigned char* data, size_t& offset) {
+    T value;
+    std::memcpy(&value, data + offset, sizeof(T));
+    offset += sizeof(T);
+    return value;
+  }
+
+  MappedFile m_file;              ///< Mapped table file.
+  DESKeyMask m_mask;              ///< Keyspace of the table.
+  uint64_t m_plaintext = 0;       ///< Chosen plaintext.
+  uint64_t m_chainCount = 0;      ///< Number of stored chains.
+  uint32_t m_chainLength = 0;     ///< Keys per chain.
+  const Chain* m_chains = nullptr;///< Chains inside the mapping, sorted by end.
+};
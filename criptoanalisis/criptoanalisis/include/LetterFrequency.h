@@ -0,0 +1,245 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @struct ShiftScore
+ * @brief Fit of one shift of a letter histogram to a language.
+ */
+struct
+ShiftScore {
+  int shift = 0;            ///< Shift (0-25) that maps plaintext letters to the ciphertext.
+  double chiSquare = 0.0;   ///< Chi-square of the unshifted histogram against the language.
+  double probability = 0.0; ///< Posterior probability of the shift (multinomial likelihood, uniform prior).
+};
+
+/**
+ * @class LetterFrequency
+ * @brief Letter histograms and their fit to English or Spanish under every shift.
+ *
+ * A shift only rotates the 26 letter counts, so after one pass over the text
+ * the fit of all shifts costs 26 * 26 operations, independent of its length.
+ * Letters are case-folded; every other byte is ignored.
+ */
+class
+LetterFrequency {
+public:
+  /// Letter counts, 'a' to 'z'.
+  using Histogram = std::array<uint64_t, 26>;
+
+  /**
+   * @brief Reference languages.
+   */
+  enum class Language {
+    English,
+    Spanish
+  };
+
+  /**
+   * @brief Name of @p language, in Spanish, for the menus.
+   */
+  static const char*
+  name(Language language) {
+    return language == Language::English ? "ingl\u00e9s" : "espa\u00f1ol";
+  }
+
+  /**
+   * @brief Letter probabilities of @p language (they add up to 1).
+   */
+  static const std::array<double, 26>&
+  reference(Language language) {
+    static const std::array<double, 26> english = normalize({
+      8.167, 1.492, 2.782, 4.253, 12.702, 2.228, 2.015, 6.094, 6.966, 0.153, 0.772, 4.025, 2.406,
+      6.749, 7.507, 1.929, 0.095, 5.987, 6.327, 9.056, 2.758, 0.978, 2.360, 0.150, 1.974, 0.074
+    });
+    static const std::array<double, 26> spanish = normalize({
+      11.525, 2.215, 4.019, 5.010, 12.181, 0.692, 1.768, 0.703, 6.247, 0.493, 0.011, 4.967, 3.157,
+      6.712, 8.683, 2.510, 0.877, 6.871, 7.977, 4.632, 2.927, 1.138, 0.017, 0.215, 1.008, 0.467
+    });
+    return language == Language::English ? english : spanish;
+  }
+
+  /**
+   * @brief Adds the letters of @p data to @p hist (for chunked input).
+   *
+   * Bytes are counted in four interleaved 256-entry tables, so consecutive
+   * equal bytes do not wait on the same counter, and folded to letters at the end.
+   */
+  static void
+  accumulate(Histogram& hist, const unsigned char* data, size_t size) {
+    std::vector<uint32_t> counts(4 * 256, 0);
+    uint32_t* c0 = counts.data();
+    uint32_t* c1 = c0 + 256;
+    uint32_t* c2 = c1 + 256;
+    uint32_t* c3 = c2 + 256;
+
+    while (size > 0) {
+      // 32-bit counters: fold before any of them can overflow
+      size_t n = std::min(size, BLOCK);
+      size_t i = 0;
+      for (; i + 4 <= n; i += 4) {
+        ++c0[data[i]];
+        ++c1[data[i + 1]];
+        ++c2[data[i + 2]];
+        ++c3[data[i + 3]];
+      }
+      for (; i < n; ++i) {
+        ++c0[data[i]];
+      }
+      for (int l = 0; l < 26; ++l) {
+        hist[l] += uint64_t(c0['a' + l]) + c1['a' + l] + c2['a' + l] + c3['a' + l]
+                 + c0['A' + l] + c1['A' + l] + c2['A' + l] + c3['A' + l];
+      }
+      std::fill(counts.begin(), counts.end(), 0);
+      data += n;
+      size -= n;
+    }
+  }
+
+  /**
+   * @brief Letter histogram of @p data.
+   */
+  static Histogram
+  histogram(const unsigned char* data, size_t size) {
+    Histogram hist{};
+    accumulate(hist, data, size);
+    return hist;
+  }
+
+  /**
+   * @brief Chi-square of @p hist, undone by @p shift, against @p language.
+   * @param hist Ciphertext letter counts.
+   * @param shift Shift assumed (plaintext letter i is ciphertext letter i + shift).
+   * @param language Reference distribution.
+   */
+  static double
+  chiSquare(const Histogram& hist, int shift, Language language) {
+    const auto& p = reference(language);
+    uint64_t total = 0;
+    for (uint64_t h : hist) total += h;
+    if (total == 0) return 0.0;
+
+    double chi = 0.0;
+    for (int i = 0; i < 26; ++i) {
+      double expected = p[i] * total;
+      double diff = static_cast<double>(hist[(i + shift) % 26]) - expected;
+      chi += diff * diff / expected;
+    }
+    return chi;
+  }
+
+  /**
+   * @brief Log-likelihood of @p hist, undone by @p shift, under @p language.
+   */
+  static double
+  logLikelihood(const Histogram& hist, int shift, Language language) {
+    const auto& logp = logReference(language);
+    double ll = 0.0;
+    for (int i = 0; i < 26; ++i) {
+      ll += hist[(i + shift) % 26] * logp[i];
+    }
+    return ll;
+  }
+
+  /**
+   * @brief Shift of @p hist with the lowest chi-square against @p language (no probability).
+   */
+  static ShiftScore
+  bestShift(const Histogram& hist, Language language) {
+    ShiftScore best;
+    best.chiSquare = std::numeric_limits<double>::infinity();
+    for (int s = 0; s < 26; ++s) {
+      double chi = chiSquare(hist, s, language);
+      if (chi < best.chiSquare) {
+        best.shift = s;
+        best.chiSquare = chi;
+      }
+    }
+    return best;
+  }
+
+  /**
+   * @brief Scores all 26 shifts of @p hist against @p language.
+   * @return The shifts sorted by chi-square, best first, with their posterior probabilities.
+   */
+  static std::vector<ShiftScore>
+  rankShifts(const Histogram& hist, Language language) {
+    std::vector<ShiftScore> ranking(26);
+    std::array<double, 26> ll;
+    for (int s = 0; s < 26; ++s) {
+      ranking[s].shift = s;
+      ranking[s].chiSquare = chiSquare(hist, s, language);
+      ll[s] = logLikelihood(hist, s, language);
+    }
+
+    // Posterior with a uniform prior: softmax of the log-likelihoods
+    double best = *std::max_element(ll.begin(), ll.end());
+    double sum = 0.0;
+    for (int s = 0; s < 26; ++s) {
+      ranking[s].probability = std::exp(ll[s] - best);
+      sum += ranking[s].probability;
+    }
+    for (auto& r : ranking) r.probability /= sum;
+
+    std::sort(ranking.begin(), ranking.end(), [](const ShiftScore& a, const ShiftScore& b) {
+      return a.chiSquare < b.chiSquare;
+    });
+    return ranking;
+  }
+
+  /**
+   * @brief Index of coincidence of @p hist: chance that two of its letters, drawn without replacement, match.
+   */
+  static double
+  coincidence(const Histogram& hist) {
+    uint64_t n = 0;
+    double pairs = 0.0;
+    for (uint64_t h : hist) {
+      n += h;
+      pairs += static_cast<double>(h) * (h - (h > 0));
+    }
+    return n > 1 ? pairs / (static_cast<double>(n) * (n - 1)) : 0.0;
+  }
+
+  /**
+   * @brief Shortest key length whose score is within 10% of the best.
+   * @param scores (length, score) pairs, shortest length first.
+   *
+   * Multiples of the true length score as well as the length itself, so the
+   * best score alone would often pick a multiple.
+   */
+  static size_t
+  shortestNearBest(const std::vector<std::pair<size_t, double>>& scores) {
+    double best = 0.0;
+    for (const auto& s : scores) best = std::max(best, s.second);
+    for (const auto& s : scores) {
+      if (s.second >= 0.9 * best) return s.first;
+    }
+    return 1;
+  }
+
+private:
+  /// Bytes counted between folds of the 32-bit counters.
+  static constexpr size_t BLOCK = size_t(1) << 30;
+
+  static std::array<double, 26>
+  normalize(std::array<double, 26> percent) {
+    double total = 0.0;
+    for (double p : percent) total += p;
+    for (double& p : percent) p /= total;
+    return percent;
+  }
+
+  static const std::array<double, 26>&
+  logReference(Language language) {
+    static const std::array<double, 26> english = logOf(reference(Language::English));
+    static const std::array<double, 26> spanish = logOf(reference(Language::Spanish));
+    return language == Language::English ? english : spanish;
+  }
+
+  static std::array<double, 26>
+  logOf(const std::array<double, 26>& p) {
+    std::array<double, 26> l;
+    for (int i = 0; i < 26; ++i) l[i] = std::log(p[i]);
+    return l;
+  }
+};
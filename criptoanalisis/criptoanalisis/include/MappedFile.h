@@ -0,0 +1,148 @@
+#pragma once
+#include "Prerequisites.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @class MappedFile
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * Pages are loaded by the OS on first access, so large tables can be
+ * searched without reading them into RAM. Move-only.
+ */
+class
+MappedFile {
+public:
+  MappedFile() = default;
+
+  /**
+   * @brief Maps @p path.
+   * @throws std::runtime_error if the file cannot be opened or mapped.
+   */
+  explicit MappedFile(const std::string& path) {
+    open(path);
+  }
+
+  ~MappedFile() {
+    close();
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+  }
+
+  MappedFile&
+  operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+      close();
+      m_data = other.m_data;
+      m_size = other.m_size;
+#ifdef _WIN32
+      m_file = other.m_file;
+      m_mapping = other.m_mapping;
+      other.m_file = INVALID_HANDLE_VALUE;
+      other.m_mapping = nullptr;
+#endif
+      other.m_data = nullptr;
+      other.m_size = 0;
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Maps @p path, closing any previous mapping.
+   * @throws std::runtime_error if the file cannot be opened or mapped.
+   */
+  void
+  open(const std::string& path) {
+    close();
+#ifdef _WIN32
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) throw std::runtime_error("Error al abrir el archivo: " + path);
+    LARGE_INTEGER size;
+    GetFileSizeEx(m_file, &size);
+    m_size = static_cast<size_t>(size.QuadPart);
+    if (m_size == 0) return;
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping != nullptr) {
+      m_data = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Error al abrir el archivo: " + path);
+    struct stat st;
+    fstat(fd, &st);
+    m_size = static_cast<size_t>(st.st_size);
+    if (m_size == 0) {
+      ::close(fd);
+      return;
+    }
+    void* p = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p != MAP_FAILED) m_data = static_cast<const unsigned char*>(p);
+#endif
+    if (m_data == nullptr) {
+      close();
+      throw std::runtime_error("Error al mapear el archivo: " + path);
+    }
+  }
+
+  /**
+   * @brief Unmaps the file (no-op if nothing is mapped).
+   */
+  void
+  close() {
+#ifdef _WIN32
+    if (m_data != nullptr) UnmapViewOfFile(m_data);
+    if (m_mapping != nullptr) CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+    m_mapping = nullptr;
+    m_file = INVALID_HANDLE_VALUE;
+#else
+    if (m_data != nullptr) munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+  }
+
+  /**
+   * @brief First byte of the mapping (nullptr for an empty file).
+   */
+  const unsigned char*
+  data() const {
+    return m_data;
+  }
+
+  /**
+   * @brief Size of the file in bytes.
+   */
+  size_t
+  size() const {
+    return m_size;
+  }
+
+private:
+  const unsigned char* m_data = nullptr;  ///< Mapped bytes.
+  size_t m_size = 0;                      ///< File size.
+#ifdef _WIN32
+  HANDLE m_file = INVALID_HANDLE_VALUE;   ///< File handle.
+  HANDLE m_mapping = nullptr;             ///< File mapping handle.
+#endif
+};
@@ -0,0 +1,475 @@
+#pragma once
+#include "Prerequisites.h"
+#include "MappedFile.h"
+#include "LetterFrequency.h"
+
+/**
+ * @class NGramModel
+ * @brief Letter n-gram language model (orders 1 to 4) shared by the crackers.
+ *
+ * Table n holds log P(letter | previous n - 1 letters) for every n-gram as
+ * a dense float array indexed in base 26 (26^4 entries for quadgrams), so a
+ * text is scored with one lookup per letter and no branches. Only letters
+ * count, case-folded; every other byte is skipped, as the ciphers skip it.
+ *
+ * Training counts the n-grams of a corpus and smooths every order towards
+ * the one below (Dirichlet back-off), ending in the letter frequencies of
+ * LetterFrequency; without a corpus the model is exactly those frequencies.
+ * Trained models are saved in a fixed binary layout (a 32-byte header and
+ * the four tables) that is memory-mapped when loaded, so startup costs no
+ * parsing and the pages are shared between processes.
+ *
+ * get() returns the model of each language: the file defaultPath() if it
+ * exists, the letter frequencies otherwise. Scoring is read-only and
+ * thread-safe; install() must not run during an attack.
+ */
+class
+NGramModel {
+public:
+  /// Highest order.
+  static constexpr size_t ORDER = 4;
+
+  NGramModel(const NGramModel&) = delete;
+  NGramModel& operator=(const NGramModel&) = delete;
+  NGramModel(NGramModel&&) = default;
+  NGramModel& operator=(NGramModel&&) = default;
+  ~NGramModel() = default;
+
+  /**
+   * @brief Model of @p language (loaded from defaultPath() on first use if the file exists).
+   */
+  static const NGramModel&
+  get(LetterFrequency::Language language) {
+    return slot(language);
+  }
+
+  /**
+   * @brief Replaces the model of its language used by get().
+   */
+  static void
+  install(NGramModel model) {
+    LetterFrequency::Language language = model.language();
+    slot(language) = std::move(model);
+  }
+
+  /**
+   * @brief File get() looks for: "Modelos/ngramas_<idioma>.ngm" under the working directory.
+   */
+  static std::string
+  defaultPath(LetterFrequency::Language language) {
+    return language == LetterFrequency::Language::English ? "Modelos/ngramas_ingles.ngm"
+                                                          : "Modelos/ngramas_espanol.ngm";
+  }
+
+  /**
+   * @brief Untrained model: the letter frequencies of @p language at every order.
+   */
+  static NGramModel
+  fromLetterFrequency(LetterFrequency::Language language) {
+    std::vector<std::vector<uint64_t>> counts;
+    for (size_t n = 1; n <= ORDER; ++n) counts.emplace_back(size(n), 0);
+    return fromCounts(language, counts);
+  }
+
+  /**
+   * @brief Trains a model on the files in @p paths (directories are read recursively).
+   * @param language Language of the corpus (the frequencies it is smoothed towards).
+   * @param paths Corpus files or directories.
+   * @throws std::runtime_error if a file cannot be opened.
+   */
+  static NGramModel
+  train(LetterFrequency::Language language, const std::vector<std::string>& paths) {
+    std::vector<std::vector<uint64_t>> counts;
+    for (size_t n = 1; n <= ORDER; ++n) counts.emplace_back(size(n), 0);
+
+    std::vector<std::string> files;
+    for (const std::string& path : paths) {
+      if (std::filesystem::is_directory(path)) {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(path)) {
+          if (entry.is_regular_file()) files.push_back(entry.path().string());
+        }
+      }
+      else {
+        files.push_back(path);
+      }
+    }
+    std::sort(files.begin(), files.end());
+
+    // One letter stream across all files: the last ORDER - 1 letters are the context
+    std::vector<char> buffer(BUFFER_SIZE);
+    uint32_t context = 0;
+    size_t seen = 0;
+    for (const std::string& file : files) {
+      std::ifstream in(file, std::ios::binary);
+      if (!in) throw std::runtime_error("Error al abrir el archivo: " + file);
+      while (in) {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        std::streamsize got = in.gcount();
+        for (std::streamsize i = 0; i < got; ++i) {
+          uint8_t l = letterIndex()[static_cast<unsigned char>(buffer[i])];
+          if (l == NOT_LETTER) continue;
+          ++seen;
+          // The n-gram ending here: the last n - 1 context letters and l
+          uint32_t gram = l;
+          uint32_t scale = 26;
+          uint32_t rest = context;
+          for (size_t n = 1; n <= ORDER && n <= seen; ++n) {
+            ++counts[n - 1][gram];
+            gram += (rest % 26) * scale;
+            rest /= 26;
+            scale *= 26;
+          }
+          context = (context * 26 + l) % static_cast<uint32_t>(size(ORDER - 1));
+        }
+      }
+    }
+    return fromCounts(language, counts);
+  }
+
+  /**
+   * @brief Memory-maps a model written by save().
+   * @throws std::runtime_error if the file cannot be opened or is not a model.
+   */
+  static NGramModel
+  load(const std::string& path) {
+    NGramModel model;
+    model.m_file.open(path);
+    const unsigned char* data = model.m_file.data();
+    Header header;
+    if (model.m_file.size() != FILE_SIZE) throw std::runtime_error("Modelo de n-gramas no v\u00e1lido: " + path);
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0 || header.version != VERSION ||
+        header.order != ORDER || header.endian != ENDIAN || header.language > 1) {
+      throw std::runtime_error("Modelo de n-gramas no v\u00e1lido: " + path);
+    }
+    model.m_language = header.language == 0 ? LetterFrequency::Language::English : LetterFrequency::Language::Spanish;
+    model.m_letters = header.letters;
+    model.setTables(reinterpret_cast<const float*>(data + sizeof(Header)));
+    return model;
+  }
+
+  /**
+   * @brief Writes the model in the layout load() maps.
+   * @throws std::runtime_error if the file cannot be written.
+   */
+  void
+  save(const std::string& path) const {
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("Error al guardar el archivo: " + path);
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.language = m_language == LetterFrequency::Language::English ? 0 : 1;
+    header.letters = m_letters;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (size_t n = 1; n <= ORDER; ++n) {
+      out.write(reinterpret_cast<const char*>(m_table[n]), static_cast<std::streamsize>(size(n) * sizeof(float)));
+    }
+    if (!out) throw std::runtime_error("Error al guardar el archivo: " + path);
+  }
+
+  /**
+   * @brief Language of the model.
+   */
+  LetterFrequency::Language
+  language() const {
+    return m_language;
+  }
+
+  /**
+   * @brief Letters of the training corpus (0 for the untrained model).
+   */
+  uint64_t
+  trainingLetters() const {
+    return m_letters;
+  }
+
+  /**
+   * @brief Table of order @p n (1-4): log P(last letter | the others), indexed in base 26.
+   */
+  const float*
+  table(size_t n) const {
+    return m_table[n];
+  }
+
+  /**
+   * @brief Letter of every byte: 0-25 for a-z/A-Z, NOT_LETTER for the rest.
+   */
+  static const std::array<uint8_t, 256>&
+  letterIndex() {
+    static const std::array<uint8_t, 256> table = []() {
+      std::array<uint8_t, 256> t;
+      t.fill(NOT_LETTER);
+      for (int i = 0; i < 26; ++i) {
+        t['a' + i] = static_cast<uint8_t>(i);
+        t['A' + i] = static_cast<uint8_t>(i);
+      }
+      return t;
+    }();
+    return table;
+  }
+
+  /**
+   * @brief The first @p limit letters of @p data as 0-25.
+   */
+  static std::vector<uint8_t>
+  letters(const unsigned char* data, size_t size, size_t limit = std::numeric_limits<size_t>::max()) {
+    const auto& index = letterIndex();
+    std::vector<uint8_t> result(std::min(size, limit));
+    size_t n = 0;
+    for (size_t i = 0; i < size && n < result.size(); ++i) {
+      // Branch-free compaction: every byte is written, only letters advance
+      result[n] = index[data[i]];
+      n += result[n] != NOT_LETTER;
+    }
+    result.resize(n);
+    return result;
+  }
+
+  /**
+   * @brief Log-likelihood (natural log) of a letter sequence (0-25).
+   *
+   * The first three letters use the lower orders; every other letter is one
+   * quadgram lookup.
+   */
+  double
+  logLikelihood(const uint8_t* text, size_t n) const {
+    double total = 0.0;
+    uint32_t context = 0;
+    size_t i = 0;
+    for (; i < n && i < ORDER - 1; ++i) {
+      context = context * 26 + text[i];
+      total += m_table[i + 1][context];
+    }
+    const float* quad = m_table[ORDER];
+    for (; i < n; ++i) {
+      uint32_t gram = (context % TRIGRAMS) * 26 + text[i];
+      total += quad[gram];
+      context = gram;
+    }
+    return total;
+  }
+
+  double
+  logLikelihood(const std::vector<uint8_t>& text) const {
+    return logLikelihood(text.data(), text.size());
+  }
+
+  /**
+   * @brief Log-likelihood of the letter sequence decrypted by each Caesar shift.
+   * @return Entry s: the letters with s subtracted from each (mod 26).
+   */
+  std::array<double, 26>
+  shiftLogLikelihoods(const uint8_t* text, size_t n) const {
+    std::array<double, 26> result;
+    std::vector<uint8_t> shifted(n);
+    for (int s = 0; s < 26; ++s) {
+      for (size_t i = 0; i < n; ++i) {
+        int l = text[i] - s;
+        shifted[i] = static_cast<uint8_t>(l + (26 & -(l < 0)));
+      }
+      result[s] = logLikelihood(shifted.data(), n);
+    }
+    return result;
+  }
+
+  /**
+   * @brief What the letter context adds to a text's likelihood, in nats.
+   *
+   * Sum over the letters of @p data that follow three others of
+   * log P(letter | those three) - log P(letter). Byte-level scores (such as
+   * CandidateScorer) already count each letter's own frequency; adding this
+   * rewards letters that follow each other as in the language. Bytes that
+   * are not letters are skipped, so a text without letters gains nothing.
+   */
+  double
+  contextGain(const unsigned char* data, size_t size) const {
+    size_t i = 0;
+    return contextGain(size, [&]() { return data[i++]; });
+  }
+
+  /**
+   * @brief contextGain() of a text given byte by byte (e.g. a decryption that is never stored).
+   * @param size Number of bytes.
+   * @param next Callable returning the next byte on each call.
+   */
+  template<typename Next>
+  double
+  contextGain(size_t size, Next&& next) const {
+    const auto& index = letterIndex();
+    const float* quad = m_table[ORDER];
+    const float* uni = m_table[1];
+    uint32_t context = 0;
+    uint32_t seen = 0;
+    double total = 0.0;
+    for (size_t i = 0; i < size; ++i) {
+      uint8_t l = index[static_cast<unsigned char>(next())];
+      uint32_t letter = l != NOT_LETTER;
+      uint32_t value = l & (0u - letter);  // 0 for non-letters
+      uint32_t gram = (context % TRIGRAMS) * 26 + value;
+      float counted = static_cast<float>(letter & (seen >= ORDER - 1));
+      total += counted * (quad[gram] - uni[value]);
+      context = letter ? gram : context;
+      seen += letter;
+    }
+    return total;
+  }
+
+  /**
+   * @brief Highest contextGain() of @p data over the languages.
+   */
+  static double
+  bestContextGain(const unsigned char* data, size_t size) {
+    return std::max(get(LetterFrequency::Language::English).contextGain(data, size),
+                    get(LetterFrequency::Language::Spanish).contextGain(data, size));
+  }
+
+  /**
+   * @brief Highest contextGain() over the languages of a text given byte by byte.
+   * @param size Number of bytes.
+   * @param makeNext Callable returning a new byte producer from the first
+   *                 byte (see contextGain(size, next)); called once per language.
+   */
+  template<typename MakeNext>
+  static double
+  bestContextGain(size_t size, MakeNext&& makeNext) {
+    return std::max(get(LetterFrequency::Language::English).contextGain(size, makeNext()),
+                    get(LetterFrequency::Language::Spanish).contextGain(size, makeNext()));
+  }
+
+  /// letterIndex() value of the bytes that are not letters.
+  static constexpr uint8_t NOT_LETTER = 0xFF;
+
+private:
+  /**
+   * @struct Header
+   * @brief First 32 bytes of a model file.
+   */
+  struct
+  Header {
+    char magic[4] = { 0, 0, 0, 0 }; ///< "NGRM".
+    uint32_t version = VERSION;     ///< Format version.
+    uint32_t language = 0;          ///< 0 = English, 1 = Spanish.
+    uint32_t order = ORDER;         ///< Highest order (the tables of 1 to order follow).
+    uint32_t endian = ENDIAN;       ///< Reads back differently on a machine of the other byte order.
+    uint32_t reserved = 0;          ///< Zero.
+    uint64_t letters = 0;           ///< Letters of the training corpus.
+  };
+
+  static constexpr char MAGIC[4] = { 'N', 'G', 'R', 'M' };
+  static constexpr uint32_t VERSION = 1;
+  static constexpr uint32_t ENDIAN = 0x01020304;
+  static constexpr uint32_t TRIGRAMS = 26 * 26 * 26;
+  /// Weight of the lower order in every n-gram estimate (pseudo-counts).
+  static constexpr double SMOOTHING = 26.0;
+  /// Bytes read per chunk while training.
+  static constexpr size_t BUFFER_SIZE = size_t(1) << 20;
+  /// Floats in the four tables.
+  static constexpr size_t TABLE_FLOATS = 26 + 26 * 26 + 26 * 26 * 26 + 26 * 26 * 26 * 26;
+  /// Exact size of a model file.
+  static constexpr size_t FILE_SIZE = 32 + TABLE_FLOATS * sizeof(float);
+
+  NGramModel() = default;
+
+  /**
+   * @brief Entries of the table of order @p n (26^n).
+   */
+  static size_t
+  size(size_t n) {
+    size_t s = 1;
+    for (size_t i = 0; i < n; ++i) s *= 26;
+    return s;
+  }
+
+  static NGramModel&
+  slot(LetterFrequency::Language language) {
+    static NGramModel english = initial(LetterFrequency::Language::English);
+    static NGramModel spanish = initial(LetterFrequency::Language::Spanish);
+    return language == LetterFrequency::Language::English ? english : spanish;
+  }
+
+  /**
+   * @brief The model in defaultPath() if it is valid, else the untrained model.
+   */
+  static NGramModel
+  initial(LetterFrequency::Language language) {
+    std::string path = defaultPath(language);
+    if (std::filesystem::exists(path)) {
+      try {
+        NGramModel model = load(path);
+        if (model.language() == language) return model;
+      }
+      catch (const std::exception&) {
+        // An unreadable model falls back to the letter frequencies
+      }
+    }
+    return fromLetterFrequency(language);
+  }
+
+  /**
+   * @brief Builds the tables from n-gram counts (counts[n - 1] has 26^n entries).
+   *
+   * P(l) = (c(l) + a * f(l)) / (N + a), with f the LetterFrequency reference,
+   * and P(l | h) = (c(hl) + a * P(l | h without its first letter)) / (c(h.) + a),
+   * where c(h.) is the count of the n-grams that start with h.
+   */
+  static NGramModel
+  fromCounts(LetterFrequency::Language language, const std::vector<std::vector<uint64_t>>& counts) {
+    NGramModel model;
+    model.m_language = language;
+    model.m_owned.resize(TABLE_FLOATS);
+    std::vector<double> lower(26);
+    std::vector<double> current;
+
+    const auto& reference = LetterFrequency::reference(language);
+    uint64_t total = 0;
+    for (uint64_t c : counts[0]) total += c;
+    model.m_letters = total;
+    for (int l = 0; l < 26; ++l) {
+      lower[l] = (counts[0][l] + SMOOTHING * reference[l]) / (total + SMOOTHING);
+      model.m_owned[l] = static_cast<float>(std::log(lower[l]));
+    }
+
+    size_t offset = 26;
+    for (size_t n = 2; n <= ORDER; ++n) {
+      const std::vector<uint64_t>& c = counts[n - 1];
+      size_t entries = size(n);
+      size_t lowerEntries = size(n - 1);
+      current.assign(entries, 0.0);
+      for (size_t h = 0; h < entries / 26; ++h) {
+        uint64_t prefix = 0;
+        for (size_t l = 0; l < 26; ++l) prefix += c[h * 26 + l];
+        for (size_t l = 0; l < 26; ++l) {
+          // Same context without its oldest letter: drop the leading base-26 digit
+          size_t backoff = (h * 26 + l) % lowerEntries;
+          current[h * 26 + l] = (c[h * 26 + l] + SMOOTHING * lower[backoff]) / (prefix + SMOOTHING);
+        }
+      }
+      for (size_t g = 0; g < entries; ++g) {
+        model.m_owned[offset + g] = static_cast<float>(std::log(current[g]));
+      }
+      offset += entries;
+      lower.swap(current);
+    }
+    model.setTables(model.m_owned.data());
+    return model;
+  }
+
+  void
+  setTables(const float* data) {
+    m_table[0] = nullptr;
+    size_t offset = 0;
+    for (size_t n = 1; n <= ORDER; ++n) {
+      m_table[n] = data + offset;
+      offset += size(n);
+    }
+  }
+
+  LetterFrequency::Language m_language = LetterFrequency::Language::English; ///< Language of the model.
+  uint64_t m_letters = 0;                        ///< Letters of the training corpus.
+  std::vector<float> m_owned;                    ///< Tables of a trained or untrained model.
+  MappedFile m_file;                             ///< Mapping of a loaded model.
+  std::array<const float*, ORDER + 1> m_table{}; ///< Table of every order (into m_owned or m_file).
+};
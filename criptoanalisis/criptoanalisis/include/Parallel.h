@@ -0,0 +1,222 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class Parallel
+ * @brief Small helpers to spread independent work across all cores.
+ *
+ * The calling thread always takes part in the work, so with a single
+ * hardware thread no extra thread is created.
+ */
+class
+Parallel {
+public:
+  /**
+   * @brief Number of worker threads to use by default.
+   * @return std::thread::hardware_concurrency(), or 1 if it is unknown.
+   */
+  static unsigned int
+  hardwareThreads() {
+    unsigned int n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+  }
+
+  /**
+   * @brief Splits [0, count) in contiguous ranges and runs them in parallel.
+   * @param count Number of work items.
+   * @param threads Number of threads (0 = hardwareThreads()).
+   * @param grain Range boundaries are multiples of this value (except the last one).
+   * @param fn Callable invoked as fn(begin, end) once per range.
+   */
+  template<typename Fn>
+  static void
+  forRange(size_t count, unsigned int threads, size_t grain, Fn&& fn) {
+    if (count == 0) return;
+    if (threads == 0) threads = hardwareThreads();
+    if (grain == 0) grain = 1;
+
+    size_t units = (count + grain - 1) / grain;
+    size_t workers = std::min<size_t>(threads, units);
+    size_t perWorker = (units + workers - 1) / workers;
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (size_t w = 1; w < workers; ++w) {
+      size_t begin = std::min(count, w * perWorker * grain);
+      size_t end = std::min(count, (w + 1) * perWorker * grain);
+      if (begin < end) {
+        pool.emplace_back([&fn, begin, end]() { fn(begin, end); });
+      }
+    }
+    fn(0, std::min(count, perWorker * grain));
+
+    for (auto& t : pool) {
+      t.join();
+    }
+  }
+
+  /**
+   * @brief Runs [0, count) over a work-stealing scheduler.
+   *
+   * Every worker starts with a contiguous share and takes @p grain items at a
+   * time from its front. A worker that runs out steals the back half of the
+   * largest remaining share, so uneven work still keeps all cores busy.
+   * @param count Number of work items.
+   * @param threads Number of threads (0 = hardwareThreads()).
+   * @param grain Items taken per step.
+   * @param fn Callable invoked as fn(begin, end); returning false stops every worker.
+   * @return False if some call to @p fn requested the stop.
+   */
+  template<typename Fn>
+  static bool
+  forStealing(uint64_t count, unsigned int threads, uint64_t grain, Fn&& fn) {
+    if (count == 0) return true;
+    if (threads == 0) threads = hardwareThreads();
+    if (grain == 0) grain = 1;
+
+    struct Share {
+      std::mutex mtx;
+      uint64_t begin = 0;
+      uint64_t end = 0;
+    };
+
+    uint64_t workers = std::min<uint64_t>(threads, (count + grain - 1) / grain);
+    std::unique_ptr<Share[]> shares(new Share[workers]);
+    for (uint64_t w = 0; w < workers; ++w) {
+      shares[w].begin = count / workers * w;
+      shares[w].end = (w + 1 == workers) ? count : count / workers * (w + 1);
+    }
+
+    std::atomic<bool> stop{ false };
+
+    auto steal = [&](uint64_t self) {
+      uint64_t victim = workers;
+      uint64_t largest = 0;
+      for (uint64_t w = 0; w < workers; ++w) {
+        if (w == self) continue;
+        std::lock_guard<std::mutex> lock(shares[w].mtx);
+        if (shares[w].end - shares[w].begin > largest) {
+          largest = shares[w].end - shares[w].begin;
+          victim = w;
+        }
+      }
+      if (victim == workers) return false;
+
+      uint64_t begin, end;
+      {
+        std::lock_guard<std::mutex> lock(shares[victim].mtx);
+        uint64_t remaining = shares[victim].end - shares[victim].begin;
+        if (remaining == 0) return true; // Raced with the owner, look again
+        end = shares[victim].end;
+        begin = shares[victim].begin + (remaining > grain ? remaining / 2 : 0);
+        shares[victim].end = begin;
+      }
+      std::lock_guard<std::mutex> lock(shares[self].mtx);
+      shares[self].begin = begin;
+      shares[self].end = end;
+      return true;
+    };
+
+    auto work = [&](uint64_t self) {
+      while (!stop.load(std::memory_order_relaxed)) {
+        uint64_t begin, end;
+        {
+          std::lock_guard<std::mutex> lock(shares[self].mtx);
+          begin = shares[self].begin;
+          end = std::min(shares[self].end, begin + grain);
+          shares[self].begin = end;
+        }
+        if (begin == end) {
+          if (!steal(self)) return;
+          continue;
+        }
+        if (!fn(begin, end)) {
+          stop = true;
+        }
+      }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (uint64_t w = 1; w < workers; ++w) {
+      pool.emplace_back(work, w);
+    }
+    work(0);
+
+    for (auto& t : pool) {
+      t.join();
+    }
+    return !stop;
+  }
+};
+
+/**
+ * @class ProgressReporter
+ * @brief Background thread that reports a work counter at a fixed interval.
+ *
+ * Every interval it calls report(count, rate) with the current value of the
+ * counter and its rate per second since the previous call. stop(), or the
+ * destructor if the work throws, wakes the thread at once and joins it.
+ * Without a report function no thread is started.
+ */
+class
+ProgressReporter {
+public:
+  using Report = std::function<void(uint64_t, double)>;
+
+  /**
+   * @brief Starts reporting.
+   * @param counter Work done so far, updated by the workers.
+   * @param report Called as report(count, rate) from the reporter thread.
+   * @param intervalSeconds Time between calls.
+   */
+  ProgressReporter(const std::atomic<uint64_t>& counter, Report report, double intervalSeconds = 1.0)
+    : m_counter(counter), m_report(std::move(report)), m_interval(intervalSeconds) {
+    if (m_report) m_thread = std::thread([this]() { loop(); });
+  }
+
+  ProgressReporter(const ProgressReporter&) = delete;
+  ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+  ~ProgressReporter() {
+    stop();
+  }
+
+  /**
+   * @brief Stops the reports; no call to report() runs after it returns.
+   */
+  void
+  stop() {
+    {
+      std::lock_guard<std::mutex> lock(m_mtx);
+      m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable()) m_thread.join();
+  }
+
+private:
+  void
+  loop() {
+    using Clock = std::chrono::steady_clock;
+    uint64_t last = m_counter.load();
+    auto lastTime = Clock::now();
+    std::unique_lock<std::mutex> lock(m_mtx);
+    while (!m_cv.wait_for(lock, m_interval, [this]() { return m_stop; })) {
+      auto now = Clock::now();
+      double dt = std::chrono::duration<double>(now - lastTime).count();
+      uint64_t current = m_counter.load();
+      m_report(current, dt > 0 ? (current - last) / dt : 0.0);
+      last = current;
+      lastTime = now;
+    }
+  }
+
+  const std::atomic<uint64_t>& m_counter;   ///< Work counter.
+  Report m_report;                          ///< Receives the reports.
+  std::chrono::duration<double> m_interval; ///< Time between reports.
+  std::mutex m_mtx;                         ///< Guards m_stop.
+  std::condition_variable m_cv;             ///< Wakes the thread on stop().
+  bool m_stop = false;                      ///< Set by stop().
+  std::thread m_thread;                     ///< Reporter thread.
+};
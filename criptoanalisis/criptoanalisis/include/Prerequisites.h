@@ -5,6 +5,8 @@
 #include <sstream>
 #include <vector>
 #include <string>
+#include <cstring>
+#include <cmath>
 #include <iomanip>
 #include <cctype>
 #include <algorithm>
@@ -14,4 +16,13 @@
 #include <random>
 #include <mutex>
 #include <array>
-#include <filesystem>
\ No newline at end of file
+#include <filesystem>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <type_traits>
+#include <limits>
+#include <condition_variable>
+#include <deque>
+#include <csignal>
\ No newline at end of file
@@ -0,0 +1,186 @@
+#pragma once
+#include "Prerequisites.h"
+#include "LetterFrequency.h"
+
+/**
+ * @struct KeyEstimate
+ * @brief Current best Caesar shift or Vigenère key of a StreamingKeyEstimator.
+ */
+struct
+KeyEstimate {
+  std::string key;               ///< Key letters ('A' = shift 0); one letter for Caesar.
+  std::vector<int> shifts;       ///< Shift of every key position (0-25).
+  double confidence = 0.0;       ///< Posterior probability of the whole key, given its length.
+  LetterFrequency::Language language = LetterFrequency::Language::English; ///< Best-fitting language.
+  uint64_t bytesRead = 0;        ///< Bytes consumed so far.
+  uint64_t letters = 0;          ///< Letters counted so far.
+  bool converged = false;        ///< The confidence passed the threshold; reading stopped.
+};
+
+/**
+ * @class StreamingKeyEstimator
+ * @brief Estimates a Caesar or Vigenère key from a stream, stopping as soon as it is sure.
+ *
+ * Letters update running histograms chunk by chunk: one per key position for
+ * every key length up to the maximum (a Caesar key is length 1). After each
+ * chunk the key length is taken from the index of coincidence of those
+ * columns, and each column is solved like a Caesar text (the 26 rotations of
+ * its histogram, as in CaesarEncryption::analyze), with one language for the
+ * whole key. Columns are independent, so the posterior of the
+ * key is the product of the column posteriors; reading stops when it passes
+ * the threshold and every column has enough letters. The time to the key
+ * depends on how clear the statistics are, not on the size of the file.
+ *
+ * The posterior assumes the key length is right; the length itself is the
+ * shortest one whose mean index of coincidence is within 10% of the best,
+ * which skips the multiples of the true length.
+ */
+class
+StreamingKeyEstimator {
+public:
+  /// Progress callback: the estimate after every chunk.
+  using ProgressFn = std::function<void(const KeyEstimate&)>;
+
+  /**
+   * @brief Constructs the estimator.
+   * @param maxKeyLength Longest key considered (1 = Caesar).
+   * @param threshold Confidence at which reading stops (0-1).
+   * @param minColumnLetters Letters each key position needs before stopping.
+   */
+  explicit StreamingKeyEstimator(size_t maxKeyLength = 1,
+                                 double threshold = 0.999,
+                                 uint64_t minColumnLetters = 40)
+    : m_maxKeyLength(std::max<size_t>(1, maxKeyLength)),
+      m_threshold(threshold),
+      m_minColumnLetters(minColumnLetters),
+      m_hist(m_maxKeyLength * (m_maxKeyLength + 1) / 2),
+      m_column(m_maxKeyLength + 1, 0) {}
+
+  ~StreamingKeyEstimator() = default;
+
+  /**
+   * @brief Adds a chunk of ciphertext to the histograms.
+   */
+  void
+  update(const unsigned char* data, size_t size) {
+    m_bytesRead += size;
+    for (size_t i = 0; i < size; ++i) {
+      unsigned char c = data[i];
+      unsigned char lower = static_cast<unsigned char>(c | 0x20);
+      if (lower < 'a' || lower > 'z') continue;
+      int letter = lower - 'a';
+      ++m_letters;
+      // Key length L uses the columns starting at L(L-1)/2
+      size_t base = 0;
+      for (size_t L = 1; L <= m_maxKeyLength; ++L) {
+        ++m_hist[base + m_column[L]][letter];
+        if (++m_column[L] == L) m_column[L] = 0;
+        base += L;
+      }
+    }
+  }
+
+  /**
+   * @brief Best key for the data seen so far.
+   */
+  KeyEstimate
+  estimate() const {
+    size_t length = keyLength();
+    const LetterFrequency::Histogram* columns = &m_hist[length * (length - 1) / 2];
+
+    // One language for the whole key: the one with the lowest total chi-square
+    KeyEstimate best;
+    double bestChi = std::numeric_limits<double>::infinity();
+    for (auto language : { LetterFrequency::Language::English, LetterFrequency::Language::Spanish }) {
+      KeyEstimate e;
+      e.language = language;
+      e.confidence = 1.0;
+      double chi = 0.0;
+      for (size_t col = 0; col < length; ++col) {
+        ShiftScore s = LetterFrequency::rankShifts(columns[col], language)[0];
+        e.shifts.push_back(s.shift);
+        e.key += static_cast<char>('A' + s.shift);
+        e.confidence *= s.probability;
+        chi += s.chiSquare;
+      }
+      if (chi < bestChi) {
+        bestChi = chi;
+        best = std::move(e);
+      }
+    }
+    best.bytesRead = m_bytesRead;
+    best.letters = m_letters;
+
+    uint64_t fewest = std::numeric_limits<uint64_t>::max();
+    for (size_t col = 0; col < length; ++col) {
+      uint64_t n = 0;
+      for (uint64_t h : columns[col]) n += h;
+      fewest = std::min(fewest, n);
+    }
+    best.converged = best.confidence >= m_threshold && fewest >= m_minColumnLetters;
+    return best;
+  }
+
+  /**
+   * @brief Reads @p in chunk by chunk until the estimate converges or the stream ends.
+   * @param in Ciphertext stream (opened in binary mode).
+   * @param progress Optional callback after every chunk.
+   * @param chunkSize Bytes read per chunk.
+   * @return The final estimate; @c converged tells whether it stopped early.
+   */
+  KeyEstimate
+  run(std::istream& in, ProgressFn progress = nullptr, size_t chunkSize = size_t(1) << 16) {
+    std::vector<char> buffer(std::max<size_t>(1, chunkSize));
+    KeyEstimate e = estimate();
+    while (in) {
+      in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      std::streamsize n = in.gcount();
+      if (n <= 0) break;
+      update(reinterpret_cast<const unsigned char*>(buffer.data()), static_cast<size_t>(n));
+      e = estimate();
+      if (progress) progress(e);
+      if (e.converged) break;
+    }
+    return e;
+  }
+
+  /**
+   * @brief run() on the file @p path.
+   * @throws std::runtime_error if the file cannot be opened.
+   */
+  KeyEstimate
+  runFile(const std::string& path, ProgressFn progress = nullptr, size_t chunkSize = size_t(1) << 16) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Error al abrir el archivo: " + path);
+    return run(in, progress, chunkSize);
+  }
+
+  /**
+   * @brief Key length with the strongest column statistics so far.
+   */
+  size_t
+  keyLength() const {
+    if (m_maxKeyLength == 1) return 1;
+    std::vector<std::pair<size_t, double>> ic(m_maxKeyLength);
+    size_t base = 0;
+    for (size_t L = 1; L <= m_maxKeyLength; ++L) {
+      double total = 0.0;
+      for (size_t col = 0; col < L; ++col) {
+        total += LetterFrequency::coincidence(m_hist[base + col]);
+      }
+      ic[L - 1] = { L, total / L };
+      base += L;
+    }
+    return LetterFrequency::shortestNearBest(ic);
+  }
+
+private:
+
+  size_t m_maxKeyLength;                          ///< Longest key considered.
+  double m_threshold;                             ///< Confidence that stops reading.
+  uint64_t m_minColumnLetters;                    ///< Letters per column required to stop.
+  std::vector<LetterFrequency::Histogram> m_hist; ///< Column histograms of every key length.
+  std::vector<size_t> m_column;                   ///< Current column of every key length.
+  uint64_t m_bytesRead = 0;                       ///< Bytes consumed.
+  uint64_t m_letters = 0;                         ///< Letters counted.
+};
@@ -0,0 +1,236 @@
+#pragma once
+#include "Prerequisites.h"
+#include "DES.h"
+#include "BitslicedDES.h"
+#include "DESBatch.h"
+
+/**
+ * @struct TripleDESKeyContext
+ * @brief Fused key schedule for 3DES-EDE: 48 subkeys per direction, side by side.
+ *
+ * encryptSchedule is E(k1) | D(k2) | E(k3) and decryptSchedule is
+ * D(k3) | E(k2) | D(k1), with the D stages already stored in reverse order,
+ * so both directions run the same 48-round loop. Trivially copyable.
+ */
+struct
+TripleDESKeyContext {
+  std::array<uint64_t, 48> encryptSchedule; ///< Subkeys of E(k1), D(k2), E(k3).
+  std::array<uint64_t, 48> decryptSchedule; ///< Subkeys of D(k3), E(k2), D(k1).
+
+  /**
+   * @brief Computes both fused schedules.
+   * @param k1 First key (applied first when encrypting).
+   * @param k2 Second key (decryption stage).
+   * @param k3 Third key.
+   */
+  void
+  rekey(uint64_t k1, uint64_t k2, uint64_t k3) {
+    DES::Subkeys s1, s2, s3;
+    DES::scheduleSubkeys(k1, s1);
+    DES::scheduleSubkeys(k2, s2);
+    DES::scheduleSubkeys(k3, s3);
+    for (int r = 0; r < 16; ++r) {
+      encryptSchedule[r] = s1[r];
+      encryptSchedule[16 + r] = s2[15 - r];
+      encryptSchedule[32 + r] = s3[r];
+      decryptSchedule[r] = s3[15 - r];
+      decryptSchedule[16 + r] = s2[r];
+      decryptSchedule[32 + r] = s1[15 - r];
+    }
+  }
+
+  /**
+   * @brief Runs the 48 rounds of a fused schedule on one block.
+   *
+   * Between the three DES stages the halves swap, exactly as feeding the
+   * output of one DES::encodeBlock into the next.
+   */
+  static uint64_t
+  rounds48(const std::array<uint64_t, 48>& schedule, uint64_t block) {
+    uint32_t left = DES::reverse32(static_cast<uint32_t>(block >> 32));
+    uint32_t right = DES::reverse32(static_cast<uint32_t>(block));
+
+    for (int stage = 0; stage < 3; ++stage) {
+      if (stage > 0) std::swap(left, right);
+      for (int r = 0; r < 16; ++r) {
+        uint32_t newRight = left ^ DES::feistelReversed(right, schedule[stage * 16 + r]);
+        left = right;
+        right = newRight;
+      }
+    }
+
+    return (static_cast<uint64_t>(DES::reverse32(right)) << 32) | DES::reverse32(left);
+  }
+
+  /**
+   * @brief Runs the 48 rounds on four independent blocks, interleaved.
+   *
+   * The four dependency chains hide the latency of the SP table lookups.
+   */
+  static void
+  rounds48x4(const std::array<uint64_t, 48>& schedule, const uint64_t* in, uint64_t* out) {
+    uint32_t left[4], right[4];
+    for (int j = 0; j < 4; ++j) {
+      left[j] = DES::reverse32(static_cast<uint32_t>(in[j] >> 32));
+      right[j] = DES::reverse32(static_cast<uint32_t>(in[j]));
+    }
+
+    for (int stage = 0; stage < 3; ++stage) {
+      if (stage > 0) {
+        for (int j = 0; j < 4; ++j) std::swap(left[j], right[j]);
+      }
+      for (int r = 0; r < 16; ++r) {
+        uint64_t subkey = schedule[stage * 16 + r];
+        for (int j = 0; j < 4; ++j) {
+          uint32_t newRight = left[j] ^ DES::feistelReversed(right[j], subkey);
+          left[j] = right[j];
+          right[j] = newRight;
+        }
+      }
+    }
+
+    for (int j = 0; j < 4; ++j) {
+      out[j] = (static_cast<uint64_t>(DES::reverse32(right[j])) << 32) | DES::reverse32(left[j]);
+    }
+  }
+};
+
+static_assert(std::is_trivially_copyable<TripleDESKeyContext>::value,
+              "TripleDESKeyContext must stay trivially copyable");
+
+/**
+ * @class TripleDES
+ * @brief Triple DES in EDE mode: C = E_k3(D_k2(E_k1(P))).
+ *
+ * Single blocks run the fused 48-round schedule of TripleDESKeyContext.
+ * Batches run four blocks interleaved, or, with wide (AVX2) slices, go
+ * through three BitslicedDES engines while the data stays bitsliced, so the
+ * transposition is paid once for all 48 rounds.
+ *
+ * Exposes the same batch interface as DESBatch, so it plugs into the block
+ * modes of DESModes.h.
+ */
+class
+TripleDES {
+public:
+  /// Preferred number of blocks per call.
+  static constexpr size_t BATCH = DESBatch::BATCH;
+
+  /**
+   * @brief Constructs 3DES from three 64-bit keys.
+   */
+  TripleDES(const std::bitset<64>& k1, const std::bitset<64>& k2, const std::bitset<64>& k3)
+    : m_k1(k1), m_k2(k2), m_k3(k3) {
+    m_context.rekey(k1.to_ullong(), k2.to_ullong(), k3.to_ullong());
+  }
+
+  ~TripleDES() = default;
+
+  /**
+   * @brief Builds 3DES from a text key of up to 24 characters.
+   *
+   * The text is split in 8-character keys (see convertTextKeyToBitset64):
+   * up to 8 characters gives k1 = k2 = k3 (same result as single DES),
+   * up to 16 gives two-key 3DES (k3 = k1), and up to 24 gives three keys.
+   * @param text The text key.
+   * @throws std::invalid_argument if the key is empty or longer than 24 characters.
+   */
+  static TripleDES
+  fromText(const std::string& text) {
+    if (text.empty() || text.size() > 24) {
+      throw std::invalid_argument("La clave 3DES debe tener entre 1 y 24 caracteres.");
+    }
+    std::bitset<64> k1 = convertTextKeyToBitset64(text.substr(0, 8));
+    std::bitset<64> k2 = text.size() > 8 ? convertTextKeyToBitset64(text.substr(8, 8)) : k1;
+    std::bitset<64> k3 = text.size() > 16 ? convertTextKeyToBitset64(text.substr(16, 8)) : k1;
+    return TripleDES(k1, k2, k3);
+  }
+
+  /**
+   * @brief Encrypts one 64-bit block.
+   */
+  std::bitset<64>
+  encode(const std::bitset<64>& plaintext) const {
+    return std::bitset<64>(encodeBlock(plaintext.to_ullong()));
+  }
+
+  /**
+   * @brief Decrypts one 64-bit block.
+   */
+  std::bitset<64>
+  decode(const std::bitset<64>& ciphertext) const {
+    return std::bitset<64>(decodeBlock(ciphertext.to_ullong()));
+  }
+
+  uint64_t
+  encodeBlock(uint64_t plaintext) const {
+    return TripleDESKeyContext::rounds48(m_context.encryptSchedule, plaintext);
+  }
+
+  uint64_t
+  decodeBlock(uint64_t ciphertext) const {
+    return TripleDESKeyContext::rounds48(m_context.decryptSchedule, ciphertext);
+  }
+
+  /**
+   * @brief Encrypts @p count independent blocks.
+   * @param in Input blocks.
+   * @param out Output blocks (may alias @p in).
+   * @param count Number of blocks.
+   */
+  void
+  encode(const uint64_t* in, uint64_t* out, size_t count) const {
+    run(in, out, count, false);
+  }
+
+  /**
+   * @brief Decrypts @p count independent blocks.
+   * @param in Input blocks.
+   * @param out Output blocks (may alias @p in).
+   * @param count Number of blocks.
+   */
+  void
+  decode(const uint64_t* in, uint64_t* out, size_t count) const {
+    run(in, out, count, true);
+  }
+
+private:
+  void
+  run(const uint64_t* in, uint64_t* out, size_t count, bool decrypt) const {
+    const auto& schedule = decrypt ? m_context.decryptSchedule : m_context.encryptSchedule;
+    size_t i = 0;
+
+    if (DESBatch::USE_BITSLICE) {
+      using Slice = BitslicedDESNative::Slice;
+      for (; i + BATCH <= count; i += BATCH) {
+        Slice s[64];
+        BitslicedDESNative::loadSlices(in + i, BATCH, s);
+        if (decrypt) {
+          m_k3.decodeSlices(s);
+          m_k2.encodeSlices(s);
+          m_k1.decodeSlices(s);
+        }
+        else {
+          m_k1.encodeSlices(s);
+          m_k2.decodeSlices(s);
+          m_k3.encodeSlices(s);
+        }
+        BitslicedDESNative::storeSlices(s, out + i, BATCH);
+      }
+    }
+
+    // Bound computed once: GCC cannot prove i + 4 <= count does not wrap and warns when inlined
+    size_t tail4 = count - (count - i) % 4;
+    for (; i < tail4; i += 4) {
+      TripleDESKeyContext::rounds48x4(schedule, in + i, out + i);
+    }
+    for (; i < count; ++i) {
+      out[i] = TripleDESKeyContext::rounds48(schedule, in[i]);
+    }
+  }
+
+  TripleDESKeyContext m_context;  ///< Fused scalar schedules.
+  BitslicedDESNative m_k1;        ///< Bitsliced engine for k1.
+  BitslicedDESNative m_k2;        ///< Bitsliced engine for k2.
+  BitslicedDESNative m_k3;        ///< Bitsliced engine for k3.
+};
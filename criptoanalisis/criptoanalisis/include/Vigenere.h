@@ -1,5 +1,9 @@
 #pragma once
 #include "Prerequisites.h"
+#include "CandidateSink.h"
+#include "VigenereBreaker.h"
+#include "WordScorer.h"
+#include "VigenereSearch.h"
 
 class
 	Vigenere {
@@ -73,8 +77,20 @@ public:
 		return result; // Return the encoded string
 	}
 
+	/**
+	 * @brief Scores a candidate plaintext by the common Spanish words it contains.
+	 * @param text Candidate plaintext (any case).
+	 * @return Total length of the word occurrences found (see fitnessScorer()).
+	 */
 	static double fitness(const std::string& text) {
-			static const std::vector<std::string> comunes = {
+		return fitnessScorer().score(text);
+	}
+
+	/**
+	 * @brief The WordScorer behind fitness(), compiled once from the common Spanish words.
+	 */
+	static WordScorer& fitnessScorer() {
+		static WordScorer scorer(std::vector<std::string>{
 			" DE ", " LA ", " EL ", " QUE ", " Y ",
 			" A ", " EN ", " UN ", " PARA ", " CON ",
 			" POR ", " COMO ", " SU ", " AL ", " DEL ",
@@ -86,52 +102,46 @@ public:
 			" PUEDE ", " TAMBIEN ", " AUN ", " MI ", " DOS ",
 			" UNO ", " OTRO ", " NUEVO ", " SIN ", " ENTRE ",
 			" SOBRE "
-		};
-
-		double score = 0;
-		for (auto& w : comunes) {
-			size_t pos = 0;
-			while ((pos = text.find(w, pos)) != std::string::npos) {
-				score += w.length();
-				pos += w.length();
-			}
-		}
-		return score;
+		});
+		return scorer;
+	}
 
+	/**
+	 * @brief Replaces the fitness() words with a list loaded from @p path (one per line).
+	 *
+	 * Call it before starting an attack; the scorer is shared by all of them.
+	 */
+	static void loadFitnessWords(const std::string& path) {
+		fitnessScorer() = WordScorer::fromFile(path);
 	}
 
-	static std::string breakEncode(const std::string& text, int maxKeyLenght) {
-		std::string bestKey;
-		std::string bestText;
-		std::string trailKey;
-
-		double bestScore = -std::numeric_limits<double>::infinity(); // Initialize best score
-
-		// Funcion revursiva para generar todas las posibles claves de longitud
-		std::function<void(int, int)> dfs = [&](int pos, int maxLen) {
-			if (pos == maxLen) {
-				Vigenere v(trailKey);
-				std::string decodedText = v.decode(text);
-				double score = fitness(decodedText); // Score the decoded text
-				if (score > bestScore) {
-					bestScore = score;
-					bestKey = trailKey;
-					bestText = decodedText;
-				}
-				return;
-			}
-			for (char c = 'A'; c <= 'Z'; ++c) {
-				trailKey[pos] = c;
-				dfs(pos + 1, maxLen);
-			}
-			};
+	/**
+	 * @brief Tries every key of 1 to @p maxKeyLenght letters and hands each decryption to @p sink.
+	 *
+	 * The keyspace is split by key prefix over all cores (VigenereKeySearch);
+	 * for pruning and checkpoints use VigenereKeySearch directly.
+	 * @param text The ciphertext.
+	 * @param maxKeyLenght Longest key tried.
+	 * @param sink Receives the keys ranked by fitness(); the plaintext is kept
+	 *             only for the keys the sink accepts.
+	 */
+	static void breakEncode(const std::string& text, int maxKeyLenght, CandidateSink& sink) {
+		VigenereKeySearch(text, fitnessScorer(), static_cast<size_t>(std::max(1, maxKeyLenght))).run(sink);
+	}
 
-		for (int L = 1; L <= maxKeyLenght; ++L) {
-			trailKey.assign(L, 'A');
-			dfs(0, L);
-		}
+	/**
+	 * @brief Recovers the key with VigenereKeyBreaker (Kasiski and index of coincidence)
+	 *        and prints it with the decryption.
+	 * @param text The ciphertext.
+	 * @param maxKeyLenght Longest key considered.
+	 * @return The key, or an empty string if the text has no letters.
+	 */
+	static std::string breakEncode(const std::string& text, int maxKeyLenght) {
+		std::vector<VigenereKeyCandidate> best = VigenereKeyBreaker(static_cast<size_t>(std::max(1, maxKeyLenght))).breakKey(text, 1);
+		std::string bestKey = best.empty() ? std::string() : best[0].key;
+		std::string bestText = best.empty() ? std::string() : Vigenere(bestKey).decode(text);
 
-		std::cout << "*** Fuerza Bruta Vigenre ***\n";
+		std::cout << "*** Criptoanlisis Vigenre ***\n";
 		std::cout << "Clave encontrada:  " << bestKey << "\n";
 		std::cout << "Texto descifrado:  " << bestText << "\n\n";
 		return bestKey;
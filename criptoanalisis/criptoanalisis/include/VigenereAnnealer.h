@@ -0,0 +1,213 @@
+#pragma once
+#include "Prerequisites.h"
+#include "Parallel.h"
+#include "NGramModel.h"
+
+/**
+ * @struct VigenereAnnealResult
+ * @brief Best key found by VigenereAnnealer.
+ */
+struct
+VigenereAnnealResult {
+  std::string key;                  ///< Key letters ('A' = shift 0).
+  double logLikelihood = -std::numeric_limits<double>::infinity(); ///< N-gram log-likelihood of the decrypted letters.
+  LetterFrequency::Language language = LetterFrequency::Language::English; ///< Model of the winning restart.
+  std::vector<double> history;      ///< Best log-likelihood of the winning restart after every sweep.
+  std::vector<double> restartScores;///< Final log-likelihood of every restart.
+  uint64_t proposals = 0;           ///< Key changes evaluated over all restarts.
+  uint64_t letters = 0;             ///< Letters scored.
+  double seconds = 0.0;             ///< Wall-clock time.
+};
+
+/**
+ * @class VigenereAnnealer
+ * @brief Stochastic Vigenère solver: simulated annealing on the key with n-gram scoring.
+ *
+ * Column statistics need many letters per key position; with long keys and
+ * short texts they fail, and trying every key is out of reach. The annealer
+ * instead changes one key letter at a time and keeps the change if the
+ * decryption becomes more likely under NGramModel, or, with probability
+ * exp(delta / T), even if it becomes less likely, so it can leave local
+ * optima while the temperature T falls.
+ *
+ * A key letter only changes the plaintext letters of its column, so a
+ * change is scored incrementally: only the quadgram windows that contain one
+ * of those letters are looked up again (about 4 * letters / keyLength per
+ * change), never the whole decryption. Independent restarts from random
+ * keys run on all cores, alternating between the trained language models
+ * (both if none is trained); the most likely key wins.
+ */
+class
+VigenereAnnealer {
+public:
+  /**
+   * @brief Constructs the solver.
+   * @param restarts Independent runs (0 = four per worker thread).
+   * @param sweeps Temperature steps per run; each one proposes every key letter 26 times.
+   * @param threads Worker threads (0 = all cores).
+   * @param seed Seed of the first restart (restart r uses seed + r).
+   */
+  explicit VigenereAnnealer(size_t restarts = 0, size_t sweeps = 100, unsigned int threads = 0,
+                            uint64_t seed = 1)
+    : m_restarts(restarts), m_sweeps(std::max<size_t>(1, sweeps)), m_threads(threads), m_seed(seed) {}
+
+  ~VigenereAnnealer() = default;
+
+  /**
+   * @brief Searches a key of @p keyLength letters for @p ciphertext.
+   * @param ciphertext The encrypted text (only its letters are used, the first SAMPLE of them).
+   * @param keyLength Key length.
+   * @param cancel Optional flag; the restarts stop at the next sweep.
+   * @return The best key over all restarts (empty if the text has no letters).
+   */
+  VigenereAnnealResult
+  solve(const std::string& ciphertext, size_t keyLength, const std::atomic<bool>* cancel = nullptr) const {
+    auto start = std::chrono::steady_clock::now();
+    keyLength = std::max<size_t>(1, keyLength);
+    std::vector<uint8_t> cipher = NGramModel::letters(
+      reinterpret_cast<const unsigned char*>(ciphertext.data()), ciphertext.size(), SAMPLE);
+    VigenereAnnealResult best;
+    best.letters = cipher.size();
+    if (cipher.empty()) return best;
+
+    // Quadgram windows (by their last letter) that contain a letter of each column
+    std::vector<std::vector<uint32_t>> windows(keyLength);
+    for (size_t col = 0; col < keyLength; ++col) {
+      for (size_t i = col; i < cipher.size(); i += keyLength) {
+        for (size_t e = i; e < i + NGramModel::ORDER && e < cipher.size(); ++e) {
+          if (windows[col].empty() || windows[col].back() < e) windows[col].push_back(static_cast<uint32_t>(e));
+        }
+      }
+    }
+
+    // An untrained model only knows letter frequencies: its restarts would be wasted
+    std::vector<LetterFrequency::Language> languages;
+    for (auto language : { LetterFrequency::Language::English, LetterFrequency::Language::Spanish }) {
+      if (NGramModel::get(language).trainingLetters() > 0) languages.push_back(language);
+    }
+    if (languages.empty()) languages = { LetterFrequency::Language::English, LetterFrequency::Language::Spanish };
+
+    unsigned int threads = m_threads == 0 ? Parallel::hardwareThreads() : m_threads;
+    size_t restarts = m_restarts == 0 ? 4 * static_cast<size_t>(threads) : m_restarts;
+    std::vector<VigenereAnnealResult> runs(restarts);
+    Parallel::forRange(restarts, threads, 1, [&](size_t begin, size_t end) {
+      for (size_t r = begin; r < end; ++r) {
+        auto language = languages[r % languages.size()];
+        runs[r] = anneal(cipher, keyLength, windows, NGramModel::get(language), m_seed + r, cancel);
+      }
+    });
+
+    for (auto& run : runs) {
+      best.restartScores.push_back(run.logLikelihood);
+      best.proposals += run.proposals;
+      if (run.logLikelihood > best.logLikelihood) {
+        best.key = std::move(run.key);
+        best.logLikelihood = run.logLikelihood;
+        best.language = run.language;
+        best.history = std::move(run.history);
+      }
+    }
+    best.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return best;
+  }
+
+private:
+  /// Letters of the ciphertext scored.
+  static constexpr size_t SAMPLE = size_t(1) << 15;
+  /// Temperature of the first sweep, in nats per letter of a column.
+  static constexpr double START_TEMPERATURE = 0.2;
+  /// Temperature of the last sweep, in nats per letter of a column.
+  static constexpr double END_TEMPERATURE = 0.005;
+
+  /**
+   * @brief Log-probability of the quadgram window that ends at @p e (lower orders near the start).
+   */
+  static double
+  window(const NGramModel& model, const uint8_t* plain, size_t e) {
+    size_t n = std::min(e + 1, NGramModel::ORDER);
+    uint32_t gram = 0;
+    for (size_t i = e + 1 - n; i <= e; ++i) gram = gram * 26 + plain[i];
+    return model.table(n)[gram];
+  }
+
+  /**
+   * @brief One annealing run from a random key.
+   */
+  VigenereAnnealResult
+  anneal(const std::vector<uint8_t>& cipher, size_t keyLength,
+         const std::vector<std::vector<uint32_t>>& windows,
+         const NGramModel& model, uint64_t seed, const std::atomic<bool>* cancel) const {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> letter(0, 25);
+    std::uniform_int_distribution<int> other(1, 25);
+    std::uniform_int_distribution<size_t> column(0, keyLength - 1);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    std::vector<uint8_t> key(keyLength);
+    for (auto& k : key) k = static_cast<uint8_t>(letter(rng));
+    std::vector<uint8_t> plain(cipher.size());
+    for (size_t i = 0; i < cipher.size(); ++i) plain[i] = decrypt(cipher[i], key[i % keyLength]);
+    double score = model.logLikelihood(plain);
+
+    VigenereAnnealResult result;
+    result.language = model.language();
+    result.logLikelihood = score;
+    std::vector<uint8_t> bestKey = key;
+
+    // Deltas grow with the letters of a column, so the temperatures scale with them
+    double perColumn = static_cast<double>(cipher.size()) / keyLength;
+    double t0 = START_TEMPERATURE * perColumn;
+    double cooling = m_sweeps > 1 ? std::pow(END_TEMPERATURE / START_TEMPERATURE, 1.0 / (m_sweeps - 1)) : 1.0;
+    double temperature = t0;
+    size_t steps = 26 * keyLength;
+
+    for (size_t sweep = 0; sweep < m_sweeps; ++sweep) {
+      if (cancel != nullptr && cancel->load()) break;
+      for (size_t step = 0; step < steps; ++step) {
+        size_t col = column(rng);
+        uint8_t old = key[col];
+        uint8_t proposed = static_cast<uint8_t>((old + other(rng)) % 26);
+
+        // Only the windows touching this column change
+        double before = 0.0;
+        for (uint32_t e : windows[col]) before += window(model, plain.data(), e);
+        for (size_t i = col; i < cipher.size(); i += keyLength) plain[i] = decrypt(cipher[i], proposed);
+        double after = 0.0;
+        for (uint32_t e : windows[col]) after += window(model, plain.data(), e);
+        double delta = after - before;
+
+        if (delta >= 0.0 || uniform(rng) < std::exp(delta / temperature)) {
+          key[col] = proposed;
+          score += delta;
+          if (score > result.logLikelihood) {
+            result.logLikelihood = score;
+            bestKey = key;
+          }
+        }
+        else {
+          for (size_t i = col; i < cipher.size(); i += keyLength) plain[i] = decrypt(cipher[i], old);
+        }
+      }
+      result.proposals += steps;
+      result.history.push_back(result.logLikelihood);
+      temperature *= cooling;
+    }
+
+    // The running score adds up rounding; the best key is scored again from scratch
+    for (size_t i = 0; i < cipher.size(); ++i) plain[i] = decrypt(cipher[i], bestKey[i % keyLength]);
+    result.logLikelihood = model.logLikelihood(plain);
+    for (uint8_t k : bestKey) result.key += static_cast<char>('A' + k);
+    return result;
+  }
+
+  static uint8_t
+  decrypt(uint8_t c, uint8_t k) {
+    int p = c - k;
+    return static_cast<uint8_t>(p < 0 ? p + 26 : p);
+  }
+
+  size_t m_restarts;       ///< Independent runs (0 = four per thread).
+  size_t m_sweeps;         ///< Temperature steps per run.
+  unsigned int m_threads;  ///< Worker threads (0 = all cores).
+  uint64_t m_seed;         ///< Seed of the first restart.
+};
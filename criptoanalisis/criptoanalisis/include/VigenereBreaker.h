@@ -0,0 +1,237 @@
+#pragma once
+#include "Prerequisites.h"
+#include "Parallel.h"
+#include "LetterFrequency.h"
+#include "NGramModel.h"
+
+/**
+ * @struct VigenereKeyCandidate
+ * @brief One recovered Vigenère key.
+ */
+struct
+VigenereKeyCandidate {
+  size_t keyLength = 0;        ///< Key length tried.
+  double coincidence = 0.0;    ///< Mean index of coincidence of the columns for that length.
+  double kasiski = 0.0;        ///< Kasiski enrichment: repeat distances divisible by the length, times the length.
+  std::string key;             ///< Best letter ('A' = shift 0) of every column.
+  double chiSquare = 0.0;      ///< Sum of the column chi-squares with that key.
+  double logLikelihood = 0.0;  ///< Log-likelihood of the decrypted letters under the n-gram model (NGramModel).
+  LetterFrequency::Language language = LetterFrequency::Language::English; ///< Best-fitting language.
+};
+
+/**
+ * @class VigenereKeyBreaker
+ * @brief Ciphertext-only recovery of Vigenère keys by Kasiski examination and index of coincidence.
+ *
+ * Only letters advance the key, so the text is first reduced to its letters.
+ * 1. Key length: for every length L the letters are split in L columns, each
+ *    a Caesar text that keeps the index of coincidence of the language,
+ *    while a wrong L mixes shifts and flattens it. Kasiski examination adds
+ *    the distances between repeated trigrams, which are multiples of the key
+ *    length.
+ * 2. Key letters: each column's histogram is rotated through the 26 shifts
+ *    and the one with the lowest chi-square wins (LetterFrequency), so a key
+ *    of length L costs one pass over the text plus 26 * 26 * L operations
+ *    instead of 26^L decryptions.
+ * 3. Ranking: the keys found are compared by the likelihood of their
+ *    decryption under the n-gram model of the language (NGramModel), which
+ *    also sees whether the letters follow each other as in real text.
+ *
+ * Lengths are scored in parallel.
+ */
+class
+VigenereKeyBreaker {
+public:
+  /**
+   * @brief Constructs the breaker.
+   * @param maxKeyLength Longest key length considered.
+   * @param threads Worker threads (0 = all cores).
+   */
+  VigenereKeyBreaker(size_t maxKeyLength = 120, unsigned int threads = 0)
+    : m_maxKeyLength(std::max<size_t>(1, maxKeyLength)), m_threads(threads) {}
+
+  ~VigenereKeyBreaker() = default;
+
+  /**
+   * @brief Mean column index of coincidence for every key length.
+   * @param text Letters (see NGramModel::letters()).
+   * @return (length, score) pairs for 1..maxKeyLength (at least 2 letters per column).
+   */
+  std::vector<std::pair<size_t, double>>
+  keyLengthScores(const std::vector<uint8_t>& text) const {
+    size_t size = text.size();
+    size_t maxLength = std::min(m_maxKeyLength, size / 2);
+    std::vector<std::pair<size_t, double>> scores(maxLength);
+
+    Parallel::forRange(maxLength, m_threads, 1, [&](size_t begin, size_t end) {
+      std::vector<LetterFrequency::Histogram> hist;
+      for (size_t l = begin; l < end; ++l) {
+        size_t length = l + 1;
+        hist.assign(length, LetterFrequency::Histogram{});
+        columnHistograms(text.data(), size, length, hist);
+        double total = 0.0;
+        for (const auto& h : hist) total += LetterFrequency::coincidence(h);
+        scores[l] = { length, total / length };
+      }
+    });
+    return scores;
+  }
+
+  /**
+   * @brief Kasiski enrichment of every key length.
+   * @param text Letters (see NGramModel::letters()).
+   * @return (length, score) pairs for 1..maxKeyLength.
+   *
+   * For each trigram the distance to its previous occurrence is counted. A
+   * length L divides a fraction f of them, about 1/L by chance, so f * L
+   * measures how much more often than chance; it is the same for the true
+   * length and its multiples and lower for its divisors.
+   */
+  std::vector<std::pair<size_t, double>>
+  kasiskiScores(const std::vector<uint8_t>& text) const {
+    size_t maxDistance = KASISKI_SPAN * m_maxKeyLength;
+    std::vector<uint64_t> distances(maxDistance + 1, 0);
+    std::vector<int64_t> last(26 * 26 * 26, -1);
+    uint64_t total = 0;
+    for (size_t i = 0; i + 3 <= text.size(); ++i) {
+      size_t t = (text[i] * 26 + text[i + 1]) * 26 + text[i + 2];
+      if (last[t] >= 0) {
+        size_t d = i - static_cast<size_t>(last[t]);
+        if (d <= maxDistance) {
+          ++distances[d];
+          ++total;
+        }
+      }
+      last[t] = static_cast<int64_t>(i);
+    }
+
+    std::vector<std::pair<size_t, double>> scores;
+    for (size_t length = 1; length <= m_maxKeyLength; ++length) {
+      uint64_t divisible = 0;
+      for (size_t d = length; d <= maxDistance; d += length) divisible += distances[d];
+      scores.push_back({ length, total ? static_cast<double>(divisible) / total * length : 0.0 });
+    }
+    return scores;
+  }
+
+  /**
+   * @brief Best key of a given length: the chi-square shift of every column.
+   * @param text Letters (see NGramModel::letters()).
+   * @param keyLength Key length.
+   * @return The key, with the n-gram log-likelihood of the letters it decrypts.
+   */
+  VigenereKeyCandidate
+  solveKey(const std::vector<uint8_t>& text, size_t keyLength) const {
+    std::vector<LetterFrequency::Histogram> hist(keyLength, LetterFrequency::Histogram{});
+    columnHistograms(text.data(), text.size(), keyLength, hist);
+
+    // One language for the whole key: the one with the lowest total chi-square
+    VigenereKeyCandidate best;
+    best.chiSquare = std::numeric_limits<double>::infinity();
+    for (auto language : { LetterFrequency::Language::English, LetterFrequency::Language::Spanish }) {
+      VigenereKeyCandidate c;
+      c.keyLength = keyLength;
+      c.language = language;
+      for (const auto& h : hist) {
+        ShiftScore s = LetterFrequency::bestShift(h, language);
+        c.key += static_cast<char>('A' + s.shift);
+        c.chiSquare += s.chiSquare;
+      }
+      if (c.chiSquare < best.chiSquare) best = std::move(c);
+    }
+
+    std::vector<uint8_t> plain(text.size());
+    size_t col = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+      int l = text[i] - (best.key[col] - 'A');
+      plain[i] = static_cast<uint8_t>(l < 0 ? l + 26 : l);
+      if (++col == keyLength) col = 0;
+    }
+    best.logLikelihood = NGramModel::get(best.language).logLikelihood(plain);
+    return best;
+  }
+
+  /**
+   * @brief Recovers the most likely keys of @p ciphertext.
+   *
+   * The lengths proposed by the index of coincidence and by Kasiski (the
+   * shortest within 10% of the best for each, then the best by coincidence),
+   * and all their divisors, are solved and ranked by the n-gram log-likelihood
+   * of the decryption minus log(26) per key letter, so a multiple of the true
+   * length, which always fits a little better, does not beat the length itself.
+   *
+   * Only the first SAMPLE letters (at least 500 per column of the longest
+   * key) are analyzed: the statistics are settled long before, so the time
+   * does not grow with the size of the text.
+   * @param ciphertext The encrypted text.
+   * @param count Number of candidates returned.
+   * @return Candidates, most likely first.
+   */
+  std::vector<VigenereKeyCandidate>
+  breakKey(const std::string& ciphertext, size_t count = 3) const {
+    std::vector<uint8_t> text = NGramModel::letters(
+      reinterpret_cast<const unsigned char*>(ciphertext.data()), ciphertext.size(),
+      std::max(SAMPLE, 500 * m_maxKeyLength));
+    auto coincidenceScores = keyLengthScores(text);
+    if (coincidenceScores.empty()) return {};
+    auto kasiski = kasiskiScores(text);
+
+    std::vector<size_t> proposed;
+    proposed.push_back(LetterFrequency::shortestNearBest(coincidenceScores));
+    proposed.push_back(LetterFrequency::shortestNearBest(kasiski));
+    auto byCoincidence = coincidenceScores;
+    std::stable_sort(byCoincidence.begin(), byCoincidence.end(), [](const auto& a, const auto& b) {
+      return a.second > b.second;
+    });
+    for (size_t i = 0; i < byCoincidence.size() && i < std::max<size_t>(count, 8); ++i) {
+      proposed.push_back(byCoincidence[i].first);
+    }
+
+    std::vector<size_t> lengths;
+    for (size_t length : proposed) {
+      if (length > coincidenceScores.size()) continue;
+      for (size_t d = 1; d <= length; ++d) {
+        if (length % d == 0 && std::find(lengths.begin(), lengths.end(), d) == lengths.end()) {
+          lengths.push_back(d);
+        }
+      }
+    }
+
+    std::vector<VigenereKeyCandidate> result(lengths.size());
+    Parallel::forRange(lengths.size(), m_threads, 1, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        result[i] = solveKey(text, lengths[i]);
+        result[i].coincidence = coincidenceScores[lengths[i] - 1].second;
+        result[i].kasiski = kasiski[lengths[i] - 1].second;
+      }
+    });
+
+    std::stable_sort(result.begin(), result.end(), [](const VigenereKeyCandidate& a, const VigenereKeyCandidate& b) {
+      return a.logLikelihood - a.keyLength * std::log(26.0) > b.logLikelihood - b.keyLength * std::log(26.0);
+    });
+    if (result.size() > count) result.resize(count);
+    return result;
+  }
+
+private:
+  /// Letters analyzed by breakKey().
+  static constexpr size_t SAMPLE = size_t(1) << 16;
+  /// Kasiski distances are counted up to this many times the longest key.
+  static constexpr size_t KASISKI_SPAN = 64;
+
+  /**
+   * @brief Adds the first @p size letters of @p text to the @p keyLength column histograms.
+   */
+  static void
+  columnHistograms(const uint8_t* text, size_t size, size_t keyLength,
+                   std::vector<LetterFrequency::Histogram>& hist) {
+    size_t col = 0;
+    for (size_t i = 0; i < size; ++i) {
+      ++hist[col][text[i]];
+      if (++col == keyLength) col = 0;
+    }
+  }
+
+  size_t m_maxKeyLength;   ///< Longest key length considered.
+  unsigned int m_threads;  ///< Worker threads (0 = all cores).
+};
@@ -0,0 +1,469 @@
+#pragma once
+#include "Prerequisites.h"
+#include "Parallel.h"
+#include "LetterFrequency.h"
+#include "NGramModel.h"
+#include "CandidateSink.h"
+#include "WordScorer.h"
+
+/**
+ * @struct VigenereSearchResult
+ * @brief Outcome of a VigenereKeySearch run.
+ */
+struct
+VigenereSearchResult {
+  uint64_t tested = 0;          ///< Keys decrypted and scored (including resumed runs).
+  uint64_t pruned = 0;          ///< Keys skipped by the prefix bound.
+  uint64_t total = 0;           ///< Keys of 1 to maxKeyLength letters.
+  bool cancelled = false;       ///< The run was stopped; the checkpoint (if any) was saved.
+  bool resumed = false;         ///< The run continued from a checkpoint.
+  double seconds = 0.0;         ///< Wall-clock time of this run.
+  double keysPerSecond = 0.0;   ///< Keys tested per second in this run.
+};
+
+/**
+ * @class VigenereKeySearch
+ * @brief Exhaustive Vigenère key search over all cores, with prefix pruning and checkpoints.
+ *
+ * Keys of each length are split by their first PREFIX_LETTERS letters; the
+ * prefixes are scheduled with Parallel::forStealing and each one enumerates
+ * its suffixes iteratively. Every key is applied to the whole text in a
+ * reused buffer and scored with a WordScorer; the ranking goes to a
+ * CandidateSink.
+ *
+ * Pruning: the letters under key position j are a Caesar text, so a key
+ * letter k gives that column a log-likelihood LL[j][k] (LetterFrequency).
+ * A key whose letters lose more than margin * letters against the best
+ * letter of every column cannot be the plaintext, and neither can any key
+ * that starts with the same prefix, so the whole subtree is skipped as soon
+ * as its prefix passes that deficit. An infinite margin searches everything.
+ *
+ * Checkpoints: the finished prefixes of the current length, the counters
+ * and the best candidates are written to a text file periodically and when
+ * the run is cancelled; run() resumes from it and deletes it at the end.
+ */
+class
+VigenereKeySearch {
+public:
+  /// Progress callback: (keys tested or pruned, total keys, keys tested per second).
+  using ProgressFn = std::function<void(uint64_t, uint64_t, double)>;
+
+  /// Longest key supported: the key count of 1 to 14 letters overflows 64 bits.
+  static constexpr size_t MAX_KEY_LENGTH = 13;
+
+  /**
+   * @brief Prepares the search.
+   * @param ciphertext The encrypted text.
+   * @param scorer Plaintext score (e.g. Vigenere::fitnessScorer()); must outlive the search.
+   * @param maxKeyLength Longest key tried (every length from 1 is searched).
+   * @param pruneMargin Allowed log-likelihood deficit per letter (infinity = no pruning).
+   * @param threads Worker threads (0 = all cores).
+   * @throws std::invalid_argument if maxKeyLength exceeds MAX_KEY_LENGTH.
+   */
+  VigenereKeySearch(const std::string& ciphertext,
+                    const WordScorer& scorer,
+                    size_t maxKeyLength,
+                    double pruneMargin = std::numeric_limits<double>::infinity(),
+                    unsigned int threads = 0)
+    : m_text(ciphertext), m_scorer(scorer), m_maxKeyLength(std::max<size_t>(1, maxKeyLength)),
+      m_margin(pruneMargin), m_threads(threads) {
+    if (m_maxKeyLength > MAX_KEY_LENGTH) {
+      throw std::invalid_argument("La longitud maxima de clave no puede superar " + std::to_string(MAX_KEY_LENGTH) + " letras.");
+    }
+    for (int s = 0; s < 26; ++s) {
+      for (int c = 0; c < 256; ++c) {
+        m_decode[s][c] = static_cast<unsigned char>(c);
+      }
+      for (int i = 0; i < 26; ++i) {
+        m_decode[s]['a' + i] = static_cast<unsigned char>('a' + (i - s + 26) % 26);
+        m_decode[s]['A' + i] = static_cast<unsigned char>('A' + (i - s + 26) % 26);
+      }
+    }
+    m_letters = NGramModel::letters(reinterpret_cast<const unsigned char*>(m_text.data()), m_text.size());
+  }
+
+  ~VigenereKeySearch() = default;
+
+  /**
+   * @brief Number of keys of 1 to maxKeyLength letters.
+   */
+  uint64_t
+  totalKeys() const {
+    uint64_t total = 0;
+    for (size_t L = 1; L <= m_maxKeyLength; ++L) total += power(L);
+    return total;
+  }
+
+  /**
+   * @brief Searches every key length, resuming from @p checkpointPath if it exists.
+   * @param sink Receives the keys (name = the key, score = the WordScorer score).
+   * @param checkpointPath Checkpoint file ("" = no checkpoints).
+   * @param progress Optional callback, invoked about once per second.
+   * @param cancel Optional flag; setting it stops the run and saves the checkpoint.
+   * @param checkpointSeconds Seconds between checkpoints.
+   * @return Counters of the whole search and timing of this run.
+   * @throws std::runtime_error if the checkpoint belongs to another text or other parameters.
+   */
+  VigenereSearchResult
+  run(CandidateSink& sink,
+      const std::string& checkpointPath = "",
+      ProgressFn progress = nullptr,
+      const std::atomic<bool>* cancel = nullptr,
+      double checkpointSeconds = 30.0) {
+    using Clock = std::chrono::steady_clock;
+    sink.setAttack("vigenere");
+
+    VigenereSearchResult result;
+    result.total = totalKeys();
+    m_length = 1;
+    m_tested = 0;
+    m_pruned = 0;
+    m_done.assign(prefixCount(1), 0);
+    if (!checkpointPath.empty() && std::filesystem::exists(checkpointPath)) {
+      load(checkpointPath, sink);
+      result.resumed = true;
+    }
+
+    std::atomic<uint64_t> tested{ m_tested };
+    std::atomic<uint64_t> pruned{ m_pruned };
+    std::atomic<bool> cancelled{ false };
+    uint64_t testedBefore = m_tested;
+    auto start = Clock::now();
+
+    ProgressReporter::Report report, autosave;
+    if (progress) {
+      report = [&](uint64_t current, double rate) { progress(current + pruned.load(), result.total, rate); };
+    }
+    if (!checkpointPath.empty()) {
+      autosave = [&](uint64_t, double) { save(checkpointPath, sink); };
+    }
+    ProgressReporter reporter(tested, report);
+    ProgressReporter saver(tested, autosave, checkpointSeconds);
+
+    for (size_t L = m_length; L <= m_maxKeyLength && !cancelled; ++L) {
+      {
+        std::lock_guard<std::mutex> lock(m_commitMtx);
+        if (L != m_length) {
+          m_length = L;
+          m_done.assign(prefixCount(L), 0);
+        }
+      }
+      prepareLength(L);
+      Parallel::forStealing(m_done.size(), m_threads, 1, [&](uint64_t begin, uint64_t end) {
+        for (uint64_t p = begin; p < end; ++p) {
+          if (!m_done[p] && !searchPrefix(L, p, sink, tested, pruned, cancel)) {
+            cancelled = true;
+            return false;
+          }
+        }
+        return true;
+      });
+    }
+
+    reporter.stop();
+    saver.stop();
+
+    result.tested = tested.load();
+    result.pruned = pruned.load();
+    result.cancelled = cancelled.load();
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.keysPerSecond = result.seconds > 0 ? (result.tested - testedBefore) / result.seconds : 0.0;
+    if (!checkpointPath.empty()) {
+      if (result.cancelled) save(checkpointPath, sink);
+      else std::filesystem::remove(checkpointPath);
+    }
+    return result;
+  }
+
+  /**
+   * @brief Decrypts the text with @p key (letters only advance the key, as in Vigenere::decode).
+   */
+  std::string
+  decrypt(const std::string& key) const {
+    std::string plain(m_text.size(), '\0');
+    size_t k = 0;
+    for (size_t i = 0; i < m_text.size(); ++i) {
+      unsigned char c = static_cast<unsigned char>(m_text[i]);
+      unsigned char lower = static_cast<unsigned char>(c | 0x20);
+      bool letter = lower >= 'a' && lower <= 'z';
+      plain[i] = static_cast<char>(letter ? m_decode[key[k] - 'A'][c] : c);
+      if (letter && ++k == key.size()) k = 0;
+    }
+    return plain;
+  }
+
+private:
+  /// Key letters that identify a work item.
+  static constexpr size_t PREFIX_LETTERS = 3;
+  /// Candidates buffered by a worker before they are handed to the sink.
+  static constexpr size_t BATCH = 256;
+  /// Keys tested between checks of the cancel flag (a power of two).
+  static constexpr uint64_t CANCEL_CHECK = 4096;
+
+  static uint64_t
+  power(size_t exponent) {
+    uint64_t p = 1;
+    for (size_t i = 0; i < exponent; ++i) p *= 26;
+    return p;
+  }
+
+  static uint64_t
+  prefixCount(size_t length) {
+    return power(std::min(length, PREFIX_LETTERS));
+  }
+
+  /**
+   * @brief Column of every byte for key length @p L and the column log-likelihoods.
+   */
+  void
+  prepareLength(size_t L) {
+    // Column of every byte; non-letters use the extra column L (shift 0)
+    m_column.resize(m_text.size());
+    size_t k = 0;
+    for (size_t i = 0; i < m_text.size(); ++i) {
+      unsigned char lower = static_cast<unsigned char>(m_text[i] | 0x20);
+      if (lower >= 'a' && lower <= 'z') {
+        m_column[i] = static_cast<uint16_t>(k);
+        if (++k == L) k = 0;
+      }
+      else {
+        m_column[i] = static_cast<uint16_t>(L);
+      }
+    }
+
+    std::vector<LetterFrequency::Histogram> hist(L, LetterFrequency::Histogram{});
+    for (size_t i = 0; i < m_letters.size(); ++i) {
+      ++hist[i % L][m_letters[i]];
+    }
+
+    // Language with the best attainable total; deficit of every letter against its column's best
+    double bestTotal = -std::numeric_limits<double>::infinity();
+    for (auto language : { LetterFrequency::Language::English, LetterFrequency::Language::Spanish }) {
+      std::vector<std::array<double, 26>> deficit(L);
+      double total = 0.0;
+      for (size_t j = 0; j < L; ++j) {
+        double best = -std::numeric_limits<double>::infinity();
+        for (int s = 0; s < 26; ++s) {
+          deficit[j][s] = LetterFrequency::logLikelihood(hist[j], s, language);
+          best = std::max(best, deficit[j][s]);
+        }
+        for (int s = 0; s < 26; ++s) deficit[j][s] = best - deficit[j][s];
+        total += best;
+      }
+      if (total > bestTotal) {
+        bestTotal = total;
+        m_deficit = std::move(deficit);
+      }
+    }
+    m_budget = std::isinf(m_margin) ? m_margin : m_margin * static_cast<double>(m_letters.size());
+  }
+
+  /**
+   * @brief Tests every key of length @p L that starts with prefix @p p.
+   * @return false if @p cancel was set; the prefix is then left unfinished.
+   */
+  bool
+  searchPrefix(size_t L, uint64_t p, CandidateSink& sink,
+               std::atomic<uint64_t>& tested, std::atomic<uint64_t>& pruned,
+               const std::atomic<bool>* cancel) {
+    if (cancel != nullptr && cancel->load()) return false;
+    size_t P = std::min(L, PREFIX_LETTERS);
+    std::vector<int> key(L + 1, 0);   // key[L] = 0: shift of the non-letters
+    std::vector<double> deficit(L + 1, 0.0);
+    uint64_t rest = p;
+    for (size_t j = P; j-- > 0;) {
+      key[j] = static_cast<int>(rest % 26);
+      rest /= 26;
+    }
+    for (size_t j = 0; j < P; ++j) {
+      deficit[j + 1] = deficit[j] + m_deficit[j][key[j]];
+    }
+
+    uint64_t localTested = 0;
+    uint64_t localPruned = 0;
+    std::vector<AttackCandidate> batch;
+    std::string plain(m_text.size(), '\0');
+    const unsigned char* text = reinterpret_cast<const unsigned char*>(m_text.data());
+
+    auto flush = [&]() {
+      for (auto& c : batch) sink.add(std::move(c));
+      batch.clear();
+    };
+
+    auto leaf = [&]() {
+      for (size_t i = 0; i < m_text.size(); ++i) {
+        plain[i] = static_cast<char>(m_decode[key[m_column[i]]][text[i]]);
+      }
+      ++localTested;
+      double score = m_scorer.score(plain);
+      if (!sink.accepts(score)) return;
+      std::string name(L, 'A');
+      for (size_t j = 0; j < L; ++j) name[j] = static_cast<char>('A' + key[j]);
+      batch.push_back({ name, score, plain });
+      if (batch.size() >= BATCH) flush();
+    };
+
+    if (deficit[P] > m_budget) {
+      localPruned += power(L - P);
+    }
+    else if (P == L) {
+      leaf();
+    }
+    else {
+      // Odometer over positions P..L-1; key[d] = 26 means "exhausted"
+      size_t d = P;
+      key[d] = -1;
+      while (d >= P) {
+        if (++key[d] == 26) {
+          if (d == P) break;
+          --d;
+          continue;
+        }
+        deficit[d + 1] = deficit[d] + m_deficit[d][key[d]];
+        if (deficit[d + 1] > m_budget) {
+          localPruned += power(L - d - 1);
+          continue;
+        }
+        if (d + 1 == L) {
+          leaf();
+          if ((localTested & (CANCEL_CHECK - 1)) == 0 && cancel != nullptr && cancel->load()) {
+            tested += localTested;
+            return false;
+          }
+        }
+        else {
+          ++d;
+          key[d] = -1;
+        }
+      }
+    }
+    tested += localTested;
+    pruned += localPruned;
+    // The last candidates and the done bit are published together, so save() never sees one without the other
+    std::lock_guard<std::mutex> lock(m_commitMtx);
+    flush();
+    m_done[p] = 1;
+    m_tested += localTested;
+    m_pruned += localPruned;
+    return true;
+  }
+
+  /**
+   * @brief FNV-1a of the ciphertext, to tie a checkpoint to its text.
+   */
+  uint64_t
+  textHash() const {
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : m_text) {
+      h ^= c;
+      h *= 1099511628211ULL;
+    }
+    return h;
+  }
+
+  /**
+   * @brief Prefix index of a key of the current length.
+   */
+  uint64_t
+  prefixOf(const std::string& key) const {
+    uint64_t p = 0;
+    for (size_t j = 0; j < std::min(key.size(), PREFIX_LETTERS); ++j) {
+      p = p * 26 + static_cast<uint64_t>(key[j] - 'A');
+    }
+    return p;
+  }
+
+  /**
+   * @brief Writes the checkpoint (to a temporary file, then renamed).
+   *
+   * Only candidates from finished prefixes are saved, so the ones that a
+   * resumed run recomputes are not counted twice.
+   */
+  void
+  save(const std::string& path, const CandidateSink& sink) {
+    std::ostringstream out;
+    out << std::setprecision(17);
+    {
+      std::lock_guard<std::mutex> lock(m_commitMtx);
+      std::vector<AttackCandidate> candidates = sink.results();
+      out << "VIGENERE-SEARCH 1\n";
+      out << "text " << textHash() << " " << m_text.size() << "\n";
+      out << "params " << m_maxKeyLength << " " << m_margin << "\n";
+      out << "length " << m_length << "\n";
+      out << "counters " << m_tested << " " << m_pruned << "\n";
+      out << "done ";
+      for (uint8_t d : m_done) out << (d ? '1' : '0');
+      out << "\n";
+      for (const auto& c : candidates) {
+        if (c.key.size() < m_length || (c.key.size() == m_length && m_done[prefixOf(c.key)])) {
+          out << "candidate " << c.score << " " << c.key << "\n";
+        }
+      }
+    }
+
+    std::string tmp = path + ".tmp";
+    {
+      std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+      if (!file) throw std::runtime_error("Error al guardar el archivo: " + tmp);
+      file << out.str();
+    }
+    std::filesystem::rename(tmp, path);
+  }
+
+  /**
+   * @brief Restores the state written by save() and re-adds its candidates to @p sink.
+   */
+  void
+  load(const std::string& path, CandidateSink& sink) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Error al abrir el archivo: " + path);
+    auto mismatch = [&]() {
+      return std::runtime_error("El punto de control no corresponde a este texto o a estos parámetros: " + path);
+    };
+
+    std::string tag, a, b;
+    in >> tag >> a;
+    if (tag != "VIGENERE-SEARCH" || a != "1") throw mismatch();
+    in >> tag >> a >> b;
+    if (tag != "text" || std::stoull(a) != textHash() || std::stoull(b) != m_text.size()) throw mismatch();
+    in >> tag >> a >> b;
+    if (tag != "params" || std::stoull(a) != m_maxKeyLength || std::stod(b) != m_margin) throw mismatch();
+    in >> tag >> a;
+    if (tag != "length") throw mismatch();
+    m_length = std::stoul(a);
+    in >> tag >> a >> b;
+    if (tag != "counters") throw mismatch();
+    m_tested = std::stoull(a);
+    m_pruned = std::stoull(b);
+    in >> tag >> a;
+    if (tag != "done" || m_length < 1 || m_length > m_maxKeyLength || a.size() != prefixCount(m_length)) throw mismatch();
+    m_done.resize(a.size());
+    for (size_t p = 0; p < a.size(); ++p) m_done[p] = a[p] == '1';
+
+    while (in >> tag >> a >> b) {
+      if (tag != "candidate" || b.empty() || b.size() > m_length) throw mismatch();
+      for (char k : b) {
+        if (k < 'A' || k > 'Z') throw mismatch();
+      }
+      sink.add({ b, std::stod(a), decrypt(b) });
+    }
+  }
+
+  std::string m_text;                            ///< Ciphertext.
+  const WordScorer& m_scorer;                    ///< Plaintext score.
+  size_t m_maxKeyLength;                         ///< Longest key tried.
+  double m_margin;                               ///< Allowed log-likelihood deficit per letter.
+  unsigned int m_threads;                        ///< Worker threads (0 = all cores).
+  std::array<std::array<unsigned char, 256>, 26> m_decode; ///< Decryption table of every shift.
+  std::vector<uint8_t> m_letters;                ///< Letters of the text, 0-25.
+
+  std::vector<uint16_t> m_column;                ///< Key position of every byte for the current length.
+  std::vector<std::array<double, 26>> m_deficit; ///< Log-likelihood lost by each letter of each column.
+  double m_budget = 0.0;                         ///< Deficit at which a prefix is pruned.
+
+  std::mutex m_commitMtx;                        ///< Guards the state below (shared with save()).
+  size_t m_length = 1;                           ///< Key length in progress.
+  std::vector<uint8_t> m_done;                   ///< Finished prefixes of m_length.
+  uint64_t m_tested = 0;                         ///< Keys tested in finished prefixes.
+  uint64_t m_pruned = 0;                         ///< Keys pruned in finished prefixes.
+};
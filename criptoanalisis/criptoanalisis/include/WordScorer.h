@@ -0,0 +1,174 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class WordScorer
+ * @brief Scores a text by the known words it contains, in one pass (Aho-Corasick).
+ *
+ * The words are compiled once into a deterministic automaton: a trie whose
+ * missing transitions are resolved through the failure links in advance, so
+ * each input byte costs one table lookup and one addition, however many
+ * words there are. Every state carries the total weight of the words that
+ * end there, including the shorter ones reached through its failure links,
+ * so overlapping occurrences all count.
+ *
+ * Matching is case-insensitive: bytes are folded through a 256-entry table,
+ * and the bytes that occur in no word share one column of the transition
+ * table, which keeps it small. Scoring is read-only and thread-safe.
+ */
+class
+WordScorer {
+public:
+  /**
+   * @brief Scorer with no words (every text scores 0).
+   */
+  WordScorer() {
+    build({});
+  }
+
+  /**
+   * @brief Compiles @p words; each occurrence adds the word's length to the score.
+   * @param words Words, matched literally apart from case (include spaces to match whole words).
+   */
+  explicit WordScorer(const std::vector<std::string>& words) {
+    build(words);
+  }
+
+  ~WordScorer() = default;
+
+  /**
+   * @brief Loads one word per line from @p path (the line break, LF or CRLF, is not part of it).
+   * @throws std::runtime_error if the file cannot be opened.
+   */
+  static WordScorer
+  fromFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Error al abrir el archivo: " + path);
+    std::vector<std::string> words;
+    for (std::string line; std::getline(in, line);) {
+      if (!line.empty() && line.back() == '\r') line.pop_back();
+      if (!line.empty()) words.push_back(line);
+    }
+    return WordScorer(words);
+  }
+
+  /**
+   * @brief Sum of the lengths of all word occurrences in @p text.
+   */
+  double
+  score(const unsigned char* text, size_t size) const {
+    const int32_t* next = m_next.data();
+    size_t classes = m_classes;
+    int32_t state = 0;
+    double total = 0.0;
+    for (size_t i = 0; i < size; ++i) {
+      state = next[static_cast<size_t>(state) * classes + m_class[text[i]]];
+      total += m_output[state];
+    }
+    return total;
+  }
+
+  double
+  score(const std::string& text) const {
+    return score(reinterpret_cast<const unsigned char*>(text.data()), text.size());
+  }
+
+  /**
+   * @brief Number of words compiled.
+   */
+  size_t
+  words() const {
+    return m_words;
+  }
+
+  /**
+   * @brief Number of automaton states.
+   */
+  size_t
+  states() const {
+    return m_output.size();
+  }
+
+private:
+  /**
+   * @brief Case folding: a-z become A-Z, every other byte is unchanged.
+   */
+  static unsigned char
+  fold(unsigned char c) {
+    return c >= 'a' && c <= 'z' ? static_cast<unsigned char>(c - 'a' + 'A') : c;
+  }
+
+  void
+  build(const std::vector<std::string>& words) {
+    // Column of every byte: one per folded byte used by the words, 0 for the rest
+    m_class.fill(0);
+    std::array<uint16_t, 256> folded{};
+    size_t classes = 1;
+    for (const std::string& w : words) {
+      for (unsigned char c : w) {
+        unsigned char f = fold(c);
+        if (folded[f] == 0) folded[f] = static_cast<uint16_t>(classes++);
+      }
+    }
+    for (int c = 0; c < 256; ++c) {
+      m_class[c] = folded[fold(static_cast<unsigned char>(c))];
+    }
+    m_classes = classes;
+
+    // Trie (-1 = no child yet)
+    m_next.assign(classes, -1);
+    m_output.assign(1, 0.0);
+    m_words = 0;
+    for (const std::string& w : words) {
+      if (w.empty()) continue;
+      int32_t state = 0;
+      for (unsigned char c : w) {
+        size_t slot = static_cast<size_t>(state) * classes + m_class[c];
+        if (m_next[slot] < 0) {
+          m_next[slot] = static_cast<int32_t>(m_output.size());
+          m_next.resize(m_next.size() + classes, -1);
+          m_output.push_back(0.0);
+        }
+        state = m_next[slot];
+      }
+      m_output[state] += static_cast<double>(w.size());
+      ++m_words;
+    }
+
+    // Breadth-first: failure links, then every missing transition borrowed from the failure state
+    std::vector<int32_t> fail(m_output.size(), 0);
+    std::deque<int32_t> queue;
+    for (size_t c = 0; c < classes; ++c) {
+      int32_t child = m_next[c];
+      if (child < 0) {
+        m_next[c] = 0;
+      }
+      else {
+        fail[child] = 0;
+        queue.push_back(child);
+      }
+    }
+    while (!queue.empty()) {
+      int32_t state = queue.front();
+      queue.pop_front();
+      m_output[state] += m_output[fail[state]];
+      for (size_t c = 0; c < classes; ++c) {
+        size_t slot = static_cast<size_t>(state) * classes + c;
+        int32_t viaFail = m_next[static_cast<size_t>(fail[state]) * classes + c];
+        if (m_next[slot] < 0) {
+          m_next[slot] = viaFail;
+        }
+        else {
+          fail[m_next[slot]] = viaFail;
+          queue.push_back(m_next[slot]);
+        }
+      }
+    }
+  }
+
+  std::array<uint16_t, 256> m_class; ///< Transition column of every byte (case-folded).
+  size_t m_classes = 1;              ///< Columns of the transition table.
+  std::vector<int32_t> m_next;       ///< Transition table, states x columns.
+  std::vector<double> m_output;      ///< Weight of the words ending at every state.
+  size_t m_words = 0;                ///< Words compiled.
+};
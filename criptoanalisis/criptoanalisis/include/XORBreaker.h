@@ -0,0 +1,203 @@
+#pragma once
+#include "Prerequisites.h"
+#include "Parallel.h"
+#include "XORKernel.h"
+#include "CandidateScorer.h"
+
+/**
+ * @struct XORKeyCandidate
+ * @brief One recovered repeating XOR key.
+ */
+struct
+XORKeyCandidate {
+  size_t keyLength = 0;      ///< Key length tried.
+  double lengthScore = 0.0;  ///< Mean index of coincidence of the columns for that length.
+  std::string key;           ///< Best key byte of every column.
+  double textScore = 0.0;    ///< Mean per-byte text score of the decryption (higher is better).
+};
+
+/**
+ * @class XORKeyBreaker
+ * @brief Ciphertext-only recovery of repeating-key XOR keys of any length.
+ *
+ * 1. Key length: for every length L the ciphertext is split in L columns;
+ *    each column was XORed with a single byte, so it keeps the index of
+ *    coincidence of the plaintext, while a wrong L mixes several key bytes
+ *    and lowers it.
+ * 2. Key bytes: each column is solved on its own. Its byte histogram is
+ *    built once, and a key byte k scores sum_c hist[c] * weight[c ^ k]
+ *    (CandidateScorer::weights), so the cost per column is 256 x 256
+ *    regardless of the text length, and 256 * L candidates are scored
+ *    instead of 256^L keys.
+ *
+ * Columns and lengths are processed in parallel.
+ */
+class
+XORKeyBreaker {
+public:
+  /**
+   * @brief Constructs the breaker.
+   * @param maxKeyLength Longest key length considered.
+   * @param threads Worker threads (0 = all cores).
+   */
+  XORKeyBreaker(size_t maxKeyLength = 64, unsigned int threads = 0)
+    : m_maxKeyLength(std::max<size_t>(1, maxKeyLength)), m_threads(threads) {}
+
+  ~XORKeyBreaker() = default;
+
+  /**
+   * @brief Mean column index of coincidence for every key length.
+   * @param data Ciphertext.
+   * @param size Ciphertext length.
+   * @return (length, score) pairs for 1..maxKeyLength (at least 2 bytes per column).
+   */
+  std::vector<std::pair<size_t, double>>
+  keyLengthScores(const unsigned char* data, size_t size) const {
+    size_t maxLength = std::min(m_maxKeyLength, size / 2);
+    std::vector<std::pair<size_t, double>> scores(maxLength);
+
+    Parallel::forRange(maxLength, m_threads, 1, [&](size_t begin, size_t end) {
+      std::vector<uint32_t> hist(256);
+      for (size_t l = begin; l < end; ++l) {
+        size_t length = l + 1;
+        double total = 0.0;
+        for (size_t col = 0; col < length; ++col) {
+          std::fill(hist.begin(), hist.end(), 0);
+          size_t n = 0;
+          for (size_t i = col; i < size; i += length, ++n) {
+            ++hist[data[i]];
+          }
+          uint64_t pairs = 0;
+          for (uint32_t h : hist) pairs += static_cast<uint64_t>(h) * (h - (h > 0));
+          total += n > 1 ? static_cast<double>(pairs) / (static_cast<double>(n) * (n - 1)) : 0.0;
+        }
+        scores[l] = { length, total / length };
+      }
+    });
+    return scores;
+  }
+
+  /**
+   * @brief Key lengths worth trying, most likely first.
+   *
+   * Multiples of the true length score as well as the length itself, so the
+   * shortest length within 10% of the best score comes first; the others
+   * follow by score.
+   */
+  std::vector<size_t>
+  likelyKeyLengths(const unsigned char* data, size_t size, size_t count) const {
+    auto scores = keyLengthScores(data, size);
+    std::vector<size_t> result;
+    if (scores.empty()) return result;
+
+    double best = 0.0;
+    for (const auto& s : scores) best = std::max(best, s.second);
+    for (const auto& s : scores) {
+      if (s.second >= 0.9 * best) {
+        result.push_back(s.first);
+        break;
+      }
+    }
+
+    std::stable_sort(scores.begin(), scores.end(), [](const auto& a, const auto& b) {
+      return a.second > b.second;
+    });
+    for (const auto& s : scores) {
+      if (result.size() >= count) break;
+      if (std::find(result.begin(), result.end(), s.first) == result.end()) {
+        result.push_back(s.first);
+      }
+    }
+    return result;
+  }
+
+  /**
+   * @brief Best key of a given length, one column per task.
+   */
+  std::string
+  solveKey(const unsigned char* data, size_t size, size_t keyLength) const {
+    const auto& weight = CandidateScorer::weights();
+    std::string key(keyLength, '\0');
+
+    Parallel::forRange(keyLength, m_threads, 1, [&](size_t begin, size_t end) {
+      std::array<uint32_t, 256> hist;
+      for (size_t col = begin; col < end; ++col) {
+        hist.fill(0);
+        for (size_t i = col; i < size; i += keyLength) {
+          ++hist[data[i]];
+        }
+
+        double bestScore = -1e300;
+        int bestKey = 0;
+        for (int k = 0; k < 256; ++k) {
+          double score = 0.0;
+          for (int c = 0; c < 256; ++c) {
+            if (hist[c] != 0) score += hist[c] * weight[c ^ k];
+          }
+          if (score > bestScore) {
+            bestScore = score;
+            bestKey = k;
+          }
+        }
+        key[col] = static_cast<char>(bestKey);
+      }
+    });
+    return key;
+  }
+
+  /**
+   * @brief Recovers the most likely keys.
+   *
+   * The best lengths by index of coincidence, and their divisors, are solved
+   * and ranked by the log-likelihood of the decryption minus log(256) per key
+   * byte, so a multiple of the true length (which always fits a little
+   * better) does not beat the length itself.
+   * @param data Ciphertext.
+   * @param size Ciphertext length.
+   * @param count Number of candidates returned.
+   * @return Candidates, most likely first.
+   */
+  std::vector<XORKeyCandidate>
+  breakKey(const unsigned char* data, size_t size, size_t count = 3) const {
+    auto scores = keyLengthScores(data, size);
+    std::vector<size_t> lengths;
+    for (size_t length : likelyKeyLengths(data, size, std::max<size_t>(count, 8))) {
+      for (size_t d = 1; d <= length; ++d) {
+        if (length % d == 0 && std::find(lengths.begin(), lengths.end(), d) == lengths.end()) {
+          lengths.push_back(d);
+        }
+      }
+    }
+
+    std::vector<XORKeyCandidate> result;
+    std::vector<double> ranking;
+    std::vector<unsigned char> plain(size);
+    for (size_t length : lengths) {
+      XORKeyCandidate c;
+      c.keyLength = length;
+      c.lengthScore = scores[length - 1].second;
+      c.key = solveKey(data, size, length);
+      XORKernel::apply(data, plain.data(), size,
+                       reinterpret_cast<const unsigned char*>(c.key.data()), c.key.size());
+      c.textScore = CandidateScorer::textScore(plain.data(), size);
+      result.push_back(c);
+      ranking.push_back(c.textScore * size - length * std::log(256.0));
+    }
+
+    std::vector<size_t> order(result.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return ranking[a] > ranking[b];
+    });
+
+    std::vector<XORKeyCandidate> best;
+    for (size_t i = 0; i < order.size() && i < count; ++i) {
+      best.push_back(result[order[i]]);
+    }
+    return best;
+  }
+
+private:
+  size_t m_maxKeyLength;   ///< Longest key length considered.
+  unsigned int m_threads;  ///< Worker threads (0 = all cores).
+};
@@ -0,0 +1,302 @@
+#pragma once
+#include "Prerequisites.h"
+#include "Parallel.h"
+#include "XORKernel.h"
+#include "CandidateScorer.h"
+
+/**
+ * @struct XORCribKey
+ * @brief Repeating key reconstructed from a crib found in the ciphertext.
+ */
+struct
+XORCribKey {
+  std::string key;        ///< Key bytes, aligned to position 0 of the ciphertext.
+  std::string crib;       ///< Crib that revealed it.
+  size_t offset = 0;      ///< First offset of the crib in the plaintext.
+  size_t hits = 0;        ///< Offsets where the crib matched with this key.
+  bool valid = false;     ///< The whole decryption is text (CandidateScorer).
+  double score = 0.0;     ///< Mean byte log-likelihood of the decryption (first 64 KB if not valid).
+};
+
+/**
+ * @struct XORPadMatch
+ * @brief Crib placement in a pair of ciphertexts encrypted with the same key stream.
+ */
+struct
+XORPadMatch {
+  size_t first = 0;       ///< Index of one ciphertext of the pair.
+  size_t second = 0;      ///< Index of the other (first < second).
+  size_t offset = 0;      ///< Offset of the crib.
+  std::string crib;       ///< The crib, assumed in one of the two plaintexts.
+  std::string fragment;   ///< The other plaintext at that offset.
+  double score = 0.0;     ///< Mean byte log-likelihood of the fragment.
+};
+
+/**
+ * @class XORCribDragger
+ * @brief Known-plaintext (crib) attacks on XOR ciphertexts.
+ *
+ * Repeating key: with a period L, c[i] ^ c[i + L] = p[i] ^ p[i + L], so a
+ * crib of length m > L sits at offset o exactly when the ciphertext XORed
+ * with itself shifted by L contains crib[j] ^ crib[j + L]. For every period
+ * that search is a substring scan: 16 offsets at a time are filtered on the
+ * first and last byte with SSE2 compares, and the few survivors are checked
+ * in full. Each hit fixes all L key bytes; the key is verified on the whole
+ * text.
+ *
+ * Many-time pad: two ciphertexts under the same key stream XOR to
+ * p_a ^ p_b, so dragging a crib over that XOR yields the other plaintext;
+ * placements whose fragment is not text are rejected at the first bad byte.
+ */
+class
+XORCribDragger {
+public:
+  /**
+   * @brief Constructs the dragger.
+   * @param threads Worker threads (0 = all cores).
+   */
+  explicit XORCribDragger(unsigned int threads = 0)
+    : m_threads(threads) {}
+
+  ~XORCribDragger() = default;
+
+  /**
+   * @brief Finds repeating keys revealed by @p cribs.
+   * @param cipher Ciphertext.
+   * @param size Ciphertext length.
+   * @param cribs Known plaintext fragments.
+   * @param maxPeriod Longest key length considered (a crib finds periods up to its length - 3).
+   * @return One entry per distinct key, valid keys first, then by score.
+   */
+  std::vector<XORCribKey>
+  findKeys(const unsigned char* cipher, size_t size,
+           const std::vector<std::string>& cribs, size_t maxPeriod = 64) const {
+    struct Hit {
+      size_t crib;
+      size_t period;
+      size_t offset;
+    };
+
+    std::vector<std::pair<size_t, size_t>> tasks;   // (crib, period)
+    for (size_t c = 0; c < cribs.size(); ++c) {
+      size_t m = cribs[c].size();
+      for (size_t period = 1; period <= maxPeriod && period + MIN_CHECKS <= m; ++period) {
+        if (period + m <= size) tasks.push_back({ c, period });
+      }
+    }
+
+    std::vector<std::vector<Hit>> found(tasks.size());
+    Parallel::forRange(tasks.size(), m_threads, 1, [&](size_t begin, size_t end) {
+      std::vector<unsigned char> pattern;
+      for (size_t t = begin; t < end; ++t) {
+        const std::string& crib = cribs[tasks[t].first];
+        size_t period = tasks[t].second;
+        pattern.resize(crib.size() - period);
+        for (size_t j = 0; j < pattern.size(); ++j) {
+          pattern[j] = static_cast<unsigned char>(crib[j] ^ crib[j + period]);
+        }
+        scan(cipher, size, period, pattern, [&](size_t offset) {
+          if (found[t].size() < MAX_HITS) found[t].push_back({ tasks[t].first, period, offset });
+        });
+      }
+    });
+
+    // One key per (period, key bytes); a key that repeats a shorter one is reported once
+    std::vector<XORCribKey> keys;
+    for (const auto& list : found) {
+      for (const Hit& h : list) {
+        const std::string& crib = cribs[h.crib];
+        std::string key(h.period, '\0');
+        for (size_t j = 0; j < h.period; ++j) {
+          key[(h.offset + j) % h.period] = static_cast<char>(cipher[h.offset + j] ^ static_cast<unsigned char>(crib[j]));
+        }
+        key = minimalPeriod(key);
+
+        auto it = std::find_if(keys.begin(), keys.end(), [&](const XORCribKey& k) { return k.key == key; });
+        if (it != keys.end()) {
+          ++it->hits;
+          it->offset = std::min(it->offset, h.offset);
+          continue;
+        }
+        XORCribKey k;
+        k.key = key;
+        k.crib = crib;
+        k.offset = h.offset;
+        k.hits = 1;
+        keys.push_back(k);
+      }
+    }
+
+    for (auto& k : keys) {
+      const unsigned char* key = reinterpret_cast<const unsigned char*>(k.key.data());
+      CandidateScore s = CandidateScorer::evaluateXOR(cipher, size, key, k.key.size());
+      k.valid = s.valid;
+      if (s.valid) {
+        k.score = s.score();
+      }
+      else {
+        // Not text everywhere (binary or non-ASCII plaintext, or a false hit): rank on a sample
+        size_t sample = std::min(size, SCORE_SAMPLE);
+        std::vector<unsigned char> plain(sample);
+        XORKernel::apply(cipher, plain.data(), sample, key, k.key.size());
+        k.score = CandidateScorer::textScore(plain.data(), sample);
+      }
+    }
+    std::stable_sort(keys.begin(), keys.end(), [](const XORCribKey& a, const XORCribKey& b) {
+      if (a.valid != b.valid) return a.valid;
+      return a.score > b.score;
+    });
+    return keys;
+  }
+
+  /**
+   * @brief Drags @p cribs over every pair of ciphertexts (many-time pad).
+   * @param ciphertexts Ciphertexts assumed to share one key stream from position 0.
+   * @param cribs Known plaintext fragments.
+   * @param maxMatches Number of placements returned.
+   * @return The placements whose implied fragment is text, best score first.
+   */
+  std::vector<XORPadMatch>
+  dragPairs(const std::vector<std::vector<unsigned char>>& ciphertexts,
+            const std::vector<std::string>& cribs, size_t maxMatches = 20) const {
+    // c_a ^ c_b is symmetric: the crib in either text gives the other one
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t a = 0; a < ciphertexts.size(); ++a) {
+      for (size_t b = a + 1; b < ciphertexts.size(); ++b) {
+        pairs.push_back({ a, b });
+      }
+    }
+
+    std::mutex mtx;
+    std::vector<XORPadMatch> matches;
+    Parallel::forRange(pairs.size(), m_threads, 1, [&](size_t begin, size_t end) {
+      std::vector<XORPadMatch> local;
+      std::vector<unsigned char> mixed;
+      for (size_t p = begin; p < end; ++p) {
+        const auto& a = ciphertexts[pairs[p].first];
+        const auto& b = ciphertexts[pairs[p].second];
+        size_t n = std::min(a.size(), b.size());
+        mixed.resize(n);
+        XORKernel::apply(a.data(), mixed.data(), n, b.data(), n);
+
+        for (const std::string& crib : cribs) {
+          if (crib.empty() || crib.size() > n) continue;
+          const unsigned char* key = reinterpret_cast<const unsigned char*>(crib.data());
+          for (size_t o = 0; o + crib.size() <= n; ++o) {
+            CandidateScore s = CandidateScorer::evaluateXOR(mixed.data() + o, crib.size(), key, crib.size());
+            if (!s.valid) continue;
+
+            XORPadMatch m;
+            m.first = pairs[p].first;
+            m.second = pairs[p].second;
+            m.offset = o;
+            m.crib = crib;
+            m.score = s.score();
+            local.push_back(m);
+          }
+          trim(local, maxMatches);
+        }
+      }
+      std::lock_guard<std::mutex> lock(mtx);
+      matches.insert(matches.end(), local.begin(), local.end());
+    });
+
+    trim(matches, maxMatches);
+    std::sort(matches.begin(), matches.end(), [](const XORPadMatch& x, const XORPadMatch& y) {
+      return x.score > y.score;
+    });
+    for (auto& m : matches) {
+      const auto& a = ciphertexts[m.first];
+      const auto& b = ciphertexts[m.second];
+      m.fragment.resize(m.crib.size());
+      for (size_t j = 0; j < m.crib.size(); ++j) {
+        m.fragment[j] = static_cast<char>(a[m.offset + j] ^ b[m.offset + j] ^ static_cast<unsigned char>(m.crib[j]));
+      }
+    }
+    return matches;
+  }
+
+private:
+  /// Crib bytes beyond the period that must agree (each one is a 1/256 filter).
+  static constexpr size_t MIN_CHECKS = 3;
+  /// Hits kept per (crib, period); a real key rarely needs more.
+  static constexpr size_t MAX_HITS = 256;
+  /// Bytes decrypted to rank a key whose decryption is not all text.
+  static constexpr size_t SCORE_SAMPLE = size_t(1) << 16;
+
+  /**
+   * @brief Calls @p onHit(o) for every o with c[o + j] ^ c[o + j + period] == pattern[j] for all j.
+   */
+  template<typename Fn>
+  static void
+  scan(const unsigned char* c, size_t size, size_t period,
+       const std::vector<unsigned char>& pattern, Fn&& onHit) {
+    size_t m = pattern.size();
+    if (m == 0 || size < period + m) return;
+    size_t offsets = size - period - m + 1;
+    unsigned char first = pattern[0];
+    unsigned char last = pattern[m - 1];
+
+    auto verify = [&](size_t o) {
+      for (size_t j = 1; j + 1 < m; ++j) {
+        if ((c[o + j] ^ c[o + j + period]) != pattern[j]) return;
+      }
+      onHit(o);
+    };
+
+    size_t o = 0;
+#if defined(XOR_KERNEL_X86)
+    __m128i vFirst = _mm_set1_epi8(static_cast<char>(first));
+    __m128i vLast = _mm_set1_epi8(static_cast<char>(last));
+    for (; o + 16 <= offsets; o += 16) {
+      const unsigned char* p = c + o;
+      __m128i d0 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)),
+                                 _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + period)));
+      __m128i d1 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + m - 1)),
+                                 _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + m - 1 + period)));
+      int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(d0, vFirst), _mm_cmpeq_epi8(d1, vLast)));
+      while (mask != 0) {
+        int bit = 0;
+        while (((mask >> bit) & 1) == 0) ++bit;
+        mask &= mask - 1;
+        verify(o + bit);
+      }
+    }
+#endif
+    for (; o < offsets; ++o) {
+      if ((c[o] ^ c[o + period]) == first && (c[o + m - 1] ^ c[o + m - 1 + period]) == last) {
+        verify(o);
+      }
+    }
+  }
+
+  /**
+   * @brief Shortest key that repeated gives @p key.
+   */
+  static std::string
+  minimalPeriod(const std::string& key) {
+    for (size_t d = 1; d < key.size(); ++d) {
+      if (key.size() % d != 0) continue;
+      bool periodic = true;
+      for (size_t i = d; i < key.size() && periodic; ++i) {
+        periodic = key[i] == key[i - d];
+      }
+      if (periodic) return key.substr(0, d);
+    }
+    return key;
+  }
+
+  /**
+   * @brief Keeps the @p count best matches of @p v (unordered).
+   */
+  static void
+  trim(std::vector<XORPadMatch>& v, size_t count) {
+    if (v.size() <= count) return;
+    std::nth_element(v.begin(), v.begin() + count, v.end(), [](const XORPadMatch& x, const XORPadMatch& y) {
+      return x.score > y.score;
+    });
+    v.resize(count);
+  }
+
+  unsigned int m_threads;  ///< Worker threads (0 = all cores).
+};
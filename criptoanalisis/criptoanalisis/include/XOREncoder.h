@@ -1,5 +1,11 @@
 #pragma once
 #include "Prerequisites.h"
+#include "XORKernel.h"
+#include "CandidateScorer.h"
+#include "CandidateSink.h"
+#include "NGramModel.h"
+#include "XORBreaker.h"
+#include "XORWordlistAttack.h"
 
 /**
  * @class XOREncoder
@@ -27,13 +33,54 @@ public:
    */
   std::string
   encode(const std::string& input, const std::string& key) {
-    std::string output = input;
-    for (int i = 0; i < input.size(); i++) {
-      output[i] = input[i] ^ key[i % key.size()];
-    }
+    std::string output(input.size(), '\0');
+    encode(reinterpret_cast<const unsigned char*>(input.data()),
+           reinterpret_cast<unsigned char*>(&output[0]), input.size(), key);
     return output;
   }
 
+  /**
+   * @brief Encodes a buffer into a caller-provided buffer (vectorized, see XORKernel).
+   * @param input The bytes to encode.
+   * @param output Destination of @p size bytes; may be the same as @p input.
+   * @param size Number of bytes.
+   * @param key The key (repeats if shorter than the input).
+   * @param offset Position of @p input within the whole message, for chunked use.
+   * @throws std::invalid_argument if the key is empty.
+   */
+  void
+  encode(const unsigned char* input, unsigned char* output, size_t size,
+         const std::string& key, size_t offset = 0) {
+    if (key.empty()) throw std::invalid_argument("La clave XOR no puede estar vac\u00eda.");
+    XORKernel::apply(input, output, size, reinterpret_cast<const unsigned char*>(key.data()),
+                     key.size(), offset);
+  }
+
+  /**
+   * @brief Encodes a string in place, without copying it.
+   * @param data The string to encode; replaced by the result.
+   * @param key The key (repeats if shorter than the input).
+   */
+  void
+  encodeInPlace(std::string& data, const std::string& key) {
+    if (data.empty()) return;
+    unsigned char* bytes = reinterpret_cast<unsigned char*>(&data[0]);
+    encode(bytes, bytes, data.size(), key);
+  }
+
+  /**
+   * @brief Recovers a repeating XOR key of unknown length from the ciphertext alone.
+   * @param data The ciphertext bytes.
+   * @param maxKeyLength Longest key length considered.
+   * @param count Number of candidates returned.
+   * @return Candidate keys, most likely first (see XORKeyBreaker).
+   */
+  std::vector<XORKeyCandidate>
+  breakRepeatingKey(const std::vector<unsigned char>& data, size_t maxKeyLength = 64, size_t count = 3) {
+    XORKeyBreaker breaker(maxKeyLength);
+    return breaker.breakKey(data.data(), data.size(), count);
+  }
+
   /**
    * @brief Converts a space-separated hex string to a vector of bytes.
    * @param input The input string containing hex values separated by spaces.
@@ -76,31 +123,51 @@ public:
    */
   bool 
   isValidText(const std::string& data) {
-    return std::all_of(data.begin(), data.end(), [](unsigned char c) {
-      return std::isprint(c) || std::isspace(c) || c == '\n' || c == ' ';
-      });
+    return CandidateScorer::isText(reinterpret_cast<const unsigned char*>(data.data()), data.size());
   }
 
   /**
    * @brief Performs a brute-force attack using all possible 1-byte keys.
    * @param cifrado The encrypted data as a vector of bytes.
+   * @param sink Receives every key that yields valid text, with its score.
    *
-   * Prints all possible plaintexts that result in valid text.
+   * Keys are scored against the ciphertext; the plaintext is only built for
+   * the keys the sink accepts.
    */
   void
-  bruteForce_1Byte(const std::vector<unsigned char>& cifrado) {
+  bruteForce_1Byte(const std::vector<unsigned char>& cifrado, CandidateSink& sink) {
+    sink.setAttack("xor-1byte");
     for (int clave = 0; clave < 256; ++clave) {
-      std::string result;
+      unsigned char key = static_cast<unsigned char>(clave);
+      offer(cifrado, &key, 1, sink);
+    }
+  }
 
-      for (unsigned char c : cifrado) {
-        result += static_cast<unsigned char>(c ^ clave);
-      }
+  /**
+   * @brief Performs a brute-force attack using all possible 1-byte keys.
+   * @param cifrado The encrypted data as a vector of bytes.
+   *
+   * Prints the best plaintexts that result in valid text.
+   */
+  void
+  bruteForce_1Byte(const std::vector<unsigned char>& cifrado) {
+    CandidateSink sink(PRINTED_CANDIDATES);
+    bruteForce_1Byte(cifrado, sink);
+    printCandidates(sink, "Clave 1 byte  ");
+  }
 
-      if (isValidText(result)) {
-        std::cout << "=============================\n";
-        std::cout << "Clave 1 byte  : '" << static_cast<char>(clave)
-          << "' (0x" << std::hex << std::setw(2) << std::setfill('0') << clave << ")\n";
-        std::cout << "Texto posible : " << result << "\n";
+  /**
+   * @brief Performs a brute-force attack using all possible 2-byte keys.
+   * @param cifrado The encrypted data as a vector of bytes.
+   * @param sink Receives every key that yields valid text, with its score.
+   */
+  void
+  bruteForce_2Byte(const std::vector<unsigned char>& cifrado, CandidateSink& sink) {
+    sink.setAttack("xor-2byte");
+    for (int b1 = 0; b1 < 256; ++b1) {
+      for (int b2 = 0; b2 < 256; ++b2) {
+        unsigned char key[2] = { static_cast<unsigned char>(b1), static_cast<unsigned char>(b2) };
+        offer(cifrado, key, 2, sink);
       }
     }
   }
@@ -109,28 +176,30 @@ public:
    * @brief Performs a brute-force attack using all possible 2-byte keys.
    * @param cifrado The encrypted data as a vector of bytes.
    *
-   * Prints all possible plaintexts that result in valid text.
+   * Prints the best plaintexts that result in valid text.
    */
   void
   bruteForce_2Byte(const std::vector<unsigned char>& cifrado) {
-    for (int b1 = 0; b1 < 256; ++b1) {
-      for (int b2 = 0; b2 < 256; ++b2) {
-        std::string result;
-        unsigned char key[2] = { static_cast<unsigned char>(b1), static_cast<unsigned char>(b2) };
-
-        for (int i = 0; i < cifrado.size(); i++) {
-          result += cifrado[i] ^ key[i % 2];
-        }
+    CandidateSink sink(PRINTED_CANDIDATES);
+    bruteForce_2Byte(cifrado, sink);
+    printCandidates(sink, "Clave 2 bytes ");
+  }
 
-        if (isValidText(result)) {
-          std::cout << "=============================\n";
-          std::cout << "Clave 2 bytes : '" << static_cast<char>(b1) << static_cast<char>(b2)
-            << "' (0x" << std::hex << std::setw(2) << std::setfill('0') << b1
-            << " 0x" << std::setw(2) << std::setfill('0') << b2 << ")\n";
-          std::cout << "Texto posible : " << result << "\n";
-        }
+  /**
+   * @brief Performs a brute-force attack using a dictionary of common keys.
+   * @param cifrado The encrypted data as a vector of bytes.
+   * @param sink Receives every key that yields valid text, with its score.
+   */
+  void
+  bruteForceByDictionary(const std::vector<unsigned char>& cifrado, CandidateSink& sink) {
+    std::vector<std::string> clavesComunes = {
+      "clave", "admin", "1234", "root", "test", "abc", "hola", "user",
+      "pass", "12345", "0000", "password", "default"
+    };
 
-      }
+    sink.setAttack("xor-diccionario");
+    for (const auto& clave : clavesComunes) {
+      offer(cifrado, reinterpret_cast<const unsigned char*>(clave.data()), clave.size(), sink);
     }
   }
 
@@ -138,25 +207,126 @@ public:
    * @brief Performs a brute-force attack using a dictionary of common keys.
    * @param cifrado The encrypted data as a vector of bytes.
    *
-   * Prints all possible plaintexts that result in valid text for each dictionary key.
+   * Prints the best plaintexts that result in valid text.
    */
   void 
   bruteForceByDictionary(const std::vector<unsigned char>& cifrado) {
-    std::vector<std::string> clavesComunes = {
-      "clave", "admin", "1234", "root", "test", "abc", "hola", "user",
-      "pass", "12345", "0000", "password", "default"
-    };
+    CandidateSink sink(PRINTED_CANDIDATES);
+    bruteForceByDictionary(cifrado, sink);
+    printCandidates(sink, "Clave de diccionario");
+  }
 
-    for (const auto& clave : clavesComunes) {
-      std::string result;
-      for (int i = 0; i < cifrado.size(); i++) {
-        result += static_cast<unsigned char>(cifrado[i] ^ clave[i % clave.size()]);
-      }
-      if (isValidText(result)) {
-        std::cout << "=============================\n";
-        std::cout << "Clave de diccionario: '" << clave << "'\n";
-        std::cout << "Texto posible : " << result << "\n";
+  /**
+   * @brief Dictionary attack with a wordlist file of any size (see XORWordlistAttack).
+   * @param cifrado The encrypted data as a vector of bytes.
+   * @param wordlistPath File with one candidate key per line.
+   * @param sink Receives every key that yields valid text, with its score.
+   * @param progress Optional callback (words tested, words/s), about once per second.
+   * @param cancel Optional flag that stops the attack.
+   * @return Statistics of the run.
+   */
+  XORWordlistResult
+  bruteForceByDictionary(const std::vector<unsigned char>& cifrado,
+                         const std::string& wordlistPath,
+                         CandidateSink& sink,
+                         XORWordlistAttack::ProgressFn progress = nullptr,
+                         const std::atomic<bool>* cancel = nullptr) {
+    sink.setAttack("xor-lista");
+    XORWordlistAttack attack(cifrado);
+    return attack.run(wordlistPath, [&](const unsigned char* key, size_t keySize) {
+      offer(cifrado, key, keySize, sink);
+    }, progress, cancel);
+  }
+
+  /**
+   * @brief Dictionary attack with a wordlist file of any size (see XORWordlistAttack).
+   * @param cifrado The encrypted data as a vector of bytes.
+   * @param wordlistPath File with one candidate key per line.
+   * @param cancel Optional flag that stops the attack.
+   *
+   * Prints the words/s once per second and the best keys that yield valid text.
+   */
+  void
+  bruteForceByDictionary(const std::vector<unsigned char>& cifrado,
+                         const std::string& wordlistPath,
+                         const std::atomic<bool>* cancel = nullptr) {
+    CandidateSink sink(PRINTED_CANDIDATES);
+    XORWordlistResult result = bruteForceByDictionary(cifrado, wordlistPath, sink,
+      [](uint64_t tested, double rate) {
+        std::cout << "  " << tested << " palabras probadas, " << static_cast<uint64_t>(rate) << " palabras/s\n";
+      }, cancel);
+
+    printCandidates(sink, "Clave de diccionario");
+    if (sink.valid() > PRINTED_CANDIDATES) {
+      std::cout << "... y " << sink.valid() - PRINTED_CANDIDATES << " claves m\u00e1s con texto v\u00e1lido.\n";
+    }
+    std::cout << result.tested << " palabras en " << result.seconds << " s ("
+      << static_cast<uint64_t>(result.wordsPerSecond) << " palabras/s)"
+      << (result.cancelled ? ", cancelado" : "") << "\n";
+  }
+
+private:
+  /// Candidates shown by the printing attacks.
+  static constexpr size_t PRINTED_CANDIDATES = 10;
+
+  /**
+   * @brief Scores one key and hands it to @p sink if it yields valid text.
+   *
+   * The score is the byte score of CandidateScorer plus the letter-context
+   * gain of the n-gram models per byte (NGramModel::bestContextGain), so
+   * plaintexts whose letters follow each other as in real text rank first.
+   */
+  static void
+  offer(const std::vector<unsigned char>& cifrado, const unsigned char* key, size_t keySize,
+        CandidateSink& sink) {
+    CandidateScore score = CandidateScorer::evaluateXOR(cifrado.data(), cifrado.size(), key, keySize);
+    if (!score.valid) return;
+    sink.note();
+
+    double total = score.score();
+    if (!cifrado.empty()) {
+      total += NGramModel::bestContextGain(cifrado.size(), [&]() {
+        return [&, i = size_t(0), k = size_t(0)]() mutable {
+          unsigned char b = cifrado[i++] ^ key[k];
+          if (++k == keySize) k = 0;
+          return b;
+        };
+      }) / cifrado.size();
+    }
+    if (sink.accepts(total)) {
+      sink.add({ std::string(reinterpret_cast<const char*>(key), keySize), total, decodeBytes(cifrado, key, keySize) });
+    }
+  }
+
+  /**
+   * @brief Prints the candidates kept by @p sink, best first.
+   */
+  static void
+  printCandidates(const CandidateSink& sink, const char* label) {
+    static const char digits[] = "0123456789abcdef";
+    for (const auto& c : sink.results()) {
+      std::string hex;
+      for (unsigned char b : c.key) {
+        hex += hex.empty() ? "0x" : " 0x";
+        hex += digits[b >> 4];
+        hex += digits[b & 15];
       }
+      std::cout << "=============================\n";
+      std::cout << label << ": '" << c.key << "' (" << hex << ")\n";
+      std::cout << "Texto posible : " << c.plaintext << "\n";
+    }
+  }
+
+  /**
+   * @brief Decrypts @p cifrado with @p key into a new string (for the keys that survive).
+   */
+  static std::string
+  decodeBytes(const std::vector<unsigned char>& cifrado, const unsigned char* key, size_t keySize) {
+    std::string result(cifrado.size(), '\0');
+    if (!cifrado.empty()) {
+      XORKernel::apply(cifrado.data(), reinterpret_cast<unsigned char*>(&result[0]), cifrado.size(),
+                       key, keySize);
     }
+    return result;
   }
 };
\ No newline at end of file
@@ -0,0 +1,200 @@
+#pragma once
+#include "Prerequisites.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define XOR_KERNEL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC/Clang need the AVX2 target enabled per function when the build does not use -mavx2
+#if defined(XOR_KERNEL_X86) && (defined(__GNUC__) || defined(__clang__))
+#define XOR_KERNEL_AVX2 __attribute__((target("avx2")))
+#else
+#define XOR_KERNEL_AVX2
+#endif
+
+/**
+ * @class XORKernel
+ * @brief Vectorized repeating-key XOR with runtime CPU dispatch.
+ *
+ * The key is expanded once into a pattern buffer (the key repeated past one
+ * unrolled step), so the key stream for any position is a single unaligned
+ * load at offset (position % key length). The offset advances by a constant
+ * per step; there is no modulo per byte. AVX2 is used when the CPU supports it,
+ * SSE2 otherwise on x86, and 64-bit words elsewhere.
+ */
+class
+XORKernel {
+public:
+  /**
+   * @brief Instruction set chosen at runtime.
+   */
+  enum class Backend {
+    Scalar,
+    SSE2,
+    AVX2
+  };
+
+  /**
+   * @brief XORs @p size bytes of @p in with the repeated @p key into @p out.
+   * @param in Input bytes.
+   * @param out Output bytes; may be the same pointer as @p in (in place).
+   * @param size Number of bytes.
+   * @param key Key bytes.
+   * @param keySize Key length (at least 1).
+   * @param offset Position of @p in within the whole message, for chunked use.
+   */
+  static void
+  apply(const unsigned char* in, unsigned char* out, size_t size,
+        const unsigned char* key, size_t keySize, size_t offset = 0) {
+    if (size == 0) return;
+    size_t k = offset % keySize;
+
+    // Short inputs: not worth building the pattern
+    if (size < 64) {
+      for (size_t i = 0; i < size; ++i) {
+        out[i] = in[i] ^ key[k];
+        if (++k == keySize) k = 0;
+      }
+      return;
+    }
+
+    std::vector<unsigned char> pattern(keySize + STEP);
+    for (size_t i = 0; i < pattern.size(); ++i) {
+      pattern[i] = key[i % keySize];
+    }
+
+    switch (backend()) {
+#if defined(XOR_KERNEL_X86)
+    case Backend::AVX2:
+      applyAVX2(in, out, size, pattern.data(), keySize, k);
+      break;
+    case Backend::SSE2:
+      applySSE2(in, out, size, pattern.data(), keySize, k);
+      break;
+#endif
+    default:
+      applyScalar(in, out, size, pattern.data(), keySize, k);
+      break;
+    }
+  }
+
+  /**
+   * @brief The backend apply() uses on this CPU (detected once).
+   */
+  static Backend
+  backend() {
+    static const Backend detected = detect();
+    return detected;
+  }
+
+private:
+  /// Bytes per unrolled step (4 AVX2 registers).
+  static constexpr size_t STEP = 128;
+
+  static Backend
+  detect() {
+#if defined(XOR_KERNEL_X86)
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] >= 7) {
+      __cpuidex(info, 7, 0);
+      bool avx2 = (info[1] & (1 << 5)) != 0;
+      __cpuid(info, 1);
+      bool osxsave = (info[2] & (1 << 27)) != 0;
+      if (avx2 && osxsave && (_xgetbv(0) & 6) == 6) return Backend::AVX2;
+    }
+    return Backend::SSE2;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return Backend::AVX2;
+    return Backend::SSE2;
+#endif
+#else
+    return Backend::Scalar;
+#endif
+  }
+
+  /**
+   * @brief Advances the key offset by one step.
+   */
+  static size_t
+  advance(size_t k, size_t step, size_t keySize) {
+    k += step;
+    return k >= keySize ? k - keySize : k;
+  }
+
+  /**
+   * @brief Finishes the last bytes; @p pattern covers k + remaining bytes.
+   */
+  static void
+  tail(const unsigned char* in, unsigned char* out, size_t size, const unsigned char* pattern) {
+    for (size_t i = 0; i < size; ++i) {
+      out[i] = in[i] ^ pattern[i];
+    }
+  }
+
+  static void
+  applyScalar(const unsigned char* in, unsigned char* out, size_t size,
+              const unsigned char* pattern, size_t keySize, size_t k) {
+    size_t step = STEP % keySize;
+    size_t i = 0;
+    for (; i + STEP <= size; i += STEP) {
+      for (size_t j = 0; j < STEP; j += 8) {
+        uint64_t a, b;
+        std::memcpy(&a, in + i + j, 8);
+        std::memcpy(&b, pattern + k + j, 8);
+        a ^= b;
+        std::memcpy(out + i + j, &a, 8);
+      }
+      k = advance(k, step, keySize);
+    }
+    tail(in + i, out + i, size - i, pattern + k);
+  }
+
+#if defined(XOR_KERNEL_X86)
+  static void
+  applySSE2(const unsigned char* in, unsigned char* out, size_t size,
+            const unsigned char* pattern, size_t keySize, size_t k) {
+    size_t step = STEP % keySize;
+    size_t i = 0;
+    for (; i + STEP <= size; i += STEP) {
+      for (size_t j = 0; j < STEP; j += 16) {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + j));
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern + k + j));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + j), _mm_xor_si128(d, p));
+      }
+      k = advance(k, step, keySize);
+    }
+    tail(in + i, out + i, size - i, pattern + k);
+  }
+
+  XOR_KERNEL_AVX2 static void
+  applyAVX2(const unsigned char* in, unsigned char* out, size_t size,
+            const unsigned char* pattern, size_t keySize, size_t k) {
+    size_t step = STEP % keySize;
+    size_t i = 0;
+    for (; i + STEP <= size; i += STEP) {
+      const unsigned char* p = pattern + k;
+      __m256i d0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+      __m256i d1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 32));
+      __m256i d2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 64));
+      __m256i d3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 96));
+      d0 = _mm256_xor_si256(d0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+      d1 = _mm256_xor_si256(d1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32)));
+      d2 = _mm256_xor_si256(d2, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 64)));
+      d3 = _mm256_xor_si256(d3, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 96)));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), d0);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 32), d1);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 64), d2);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 96), d3);
+      k = advance(k, step, keySize);
+    }
+    tail(in + i, out + i, size - i, pattern + k);
+  }
+#endif
+};
@@ -0,0 +1,244 @@
+#pragma once
+#include "Prerequisites.h"
+#include "Parallel.h"
+#include "XORKernel.h"
+#include "CandidateScorer.h"
+
+/**
+ * @struct XORLineCandidate
+ * @brief Line that looks like text XORed with one byte.
+ */
+struct
+XORLineCandidate {
+  size_t line = 0;         ///< Line number (1-based).
+  unsigned char key = 0;   ///< Best key byte.
+  double score = 0.0;      ///< Mean byte log-likelihood of the decryption (CandidateScorer::weights).
+  std::string plaintext;   ///< Decryption with @c key.
+};
+
+/**
+ * @class XORSingleByteDetector
+ * @brief Finds the lines of a hex file that are single-byte-XOR encrypted text.
+ *
+ * Every line is hex-decoded in one pass with a nibble table and reduced to a
+ * histogram of its distinct bytes. A key k scores sum_c hist[c] * w[c ^ k];
+ * with the table row[c][k] = w[c ^ k] precomputed, each distinct byte adds
+ * hist[c] * row[c] to all 256 scores at once, four keys per SSE2
+ * multiply-add (a plain loop on other targets). The file is cut in chunks
+ * at line boundaries and the chunks are spread across cores; each worker
+ * keeps its own top candidates.
+ */
+class
+XORSingleByteDetector {
+public:
+  /**
+   * @brief Constructs the detector.
+   * @param threads Worker threads (0 = all cores).
+   */
+  explicit XORSingleByteDetector(unsigned int threads = 0)
+    : m_threads(threads) {}
+
+  ~XORSingleByteDetector() = default;
+
+  /**
+   * @brief Scores every line of @p data and returns the best ones.
+   * @param data Hex lines (LF or CRLF; blank and non-hex lines are skipped).
+   * @param size Number of bytes.
+   * @param count Number of candidates returned (at least 1).
+   * @return The best lines, highest score first.
+   */
+  std::vector<XORLineCandidate>
+  detect(const unsigned char* data, size_t size, size_t count = 10) const {
+    count = std::max<size_t>(1, count);
+    size_t chunks = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    // Line numbers: count the lines that start in every chunk, then prefix sums
+    std::vector<size_t> firstLine(chunks + 1, 0);
+    Parallel::forRange(chunks, m_threads, 1, [&](size_t begin, size_t end) {
+      for (size_t chunk = begin; chunk < end; ++chunk) {
+        // A line starts at 0 and after every '\n' that is not the last byte
+        size_t pos = chunk * CHUNK_SIZE;
+        size_t limit = std::min(size, pos + CHUNK_SIZE);
+        size_t from = pos == 0 ? 0 : pos - 1;
+        firstLine[chunk + 1] = std::count(data + from, data + limit - 1, '\n') + (pos == 0 ? 1 : 0);
+      }
+    });
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+      firstLine[chunk + 1] += firstLine[chunk];
+    }
+
+    const auto& rows = scoreRows();
+    std::mutex mtx;
+    std::vector<XORLineCandidate> best;
+
+    Parallel::forRange(chunks, m_threads, 1, [&](size_t begin, size_t end) {
+      std::vector<XORLineCandidate> local;
+      std::vector<unsigned char> bytes;
+      std::array<uint32_t, 256> hist{};
+      std::array<unsigned char, 256> distinct;
+      alignas(32) float scores[256];
+
+      for (size_t chunk = begin; chunk < end; ++chunk) {
+        size_t pos = chunk * CHUNK_SIZE;
+        size_t limit = std::min(size, pos + CHUNK_SIZE);
+        size_t line = firstLine[chunk];
+        // The line that crosses into this chunk belongs to the previous one
+        if (pos > 0 && data[pos - 1] != '\n') {
+          const void* nl = std::memchr(data + pos, '\n', size - pos);
+          pos = nl ? static_cast<size_t>(static_cast<const unsigned char*>(nl) - data) + 1 : size;
+        }
+
+        while (pos < limit) {
+          ++line;
+          const void* nl = std::memchr(data + pos, '\n', size - pos);
+          size_t lineEnd = nl ? static_cast<size_t>(static_cast<const unsigned char*>(nl) - data) : size;
+          size_t next = lineEnd + 1;
+          if (lineEnd > pos && data[lineEnd - 1] == '\r') --lineEnd;
+
+          if (decodeHex(data + pos, lineEnd - pos, bytes) && !bytes.empty()) {
+            size_t n = 0;
+            for (unsigned char b : bytes) {
+              if (hist[b]++ == 0) distinct[n++] = b;
+            }
+
+            std::fill(std::begin(scores), std::end(scores), 0.0f);
+            for (size_t i = 0; i < n; ++i) {
+              accumulate(scores, rows[distinct[i]].data(), static_cast<float>(hist[distinct[i]]));
+              hist[distinct[i]] = 0;
+            }
+
+            int key = static_cast<int>(std::max_element(std::begin(scores), std::end(scores)) - std::begin(scores));
+            XORLineCandidate c;
+            c.line = line;
+            c.key = static_cast<unsigned char>(key);
+            c.score = scores[key] / bytes.size();
+            if (local.size() < count || c.score > local.front().score) {
+              local.push_back(c);
+              std::push_heap(local.begin(), local.end(), worse);
+              if (local.size() > count) {
+                std::pop_heap(local.begin(), local.end(), worse);
+                local.pop_back();
+              }
+            }
+          }
+          pos = next;
+        }
+      }
+
+      std::lock_guard<std::mutex> lock(mtx);
+      best.insert(best.end(), local.begin(), local.end());
+    });
+
+    std::sort(best.begin(), best.end(), [](const XORLineCandidate& a, const XORLineCandidate& b) {
+      return a.score > b.score;
+    });
+    if (best.size() > count) best.resize(count);
+    fillPlaintexts(data, size, best);
+    return best;
+  }
+
+private:
+  static constexpr size_t CHUNK_SIZE = size_t(1) << 20;
+
+  /// Heap order: the worst kept candidate sits at the front.
+  static bool
+  worse(const XORLineCandidate& a, const XORLineCandidate& b) {
+    return a.score > b.score;
+  }
+
+  /**
+   * @brief scores[k] += h * row[k] for the 256 keys (SSE2, 4 keys per step).
+   */
+  static void
+  accumulate(float* scores, const float* row, float h) {
+#if defined(XOR_KERNEL_X86)
+    __m128 vh = _mm_set1_ps(h);
+    for (int k = 0; k < 256; k += 4) {
+      __m128 acc = _mm_load_ps(scores + k);
+      _mm_store_ps(scores + k, _mm_add_ps(acc, _mm_mul_ps(vh, _mm_load_ps(row + k))));
+    }
+#else
+    for (int k = 0; k < 256; ++k) {
+      scores[k] += h * row[k];
+    }
+#endif
+  }
+
+  /**
+   * @brief row[c][k] = weight of the byte c ^ k (see CandidateScorer::weights).
+   */
+  static const std::vector<std::array<float, 256>>&
+  scoreRows() {
+    static const std::vector<std::array<float, 256>> rows = []() {
+      const auto& w = CandidateScorer::weights();
+      std::vector<std::array<float, 256>> r(256);
+      for (int c = 0; c < 256; ++c) {
+        for (int k = 0; k < 256; ++k) {
+          r[c][k] = static_cast<float>(w[c ^ k]);
+        }
+      }
+      return r;
+    }();
+    return rows;
+  }
+
+  /**
+   * @brief Decodes a hex line; false if its length is odd or it has non-hex characters.
+   */
+  static bool
+  decodeHex(const unsigned char* text, size_t length, std::vector<unsigned char>& out) {
+    static const std::array<int8_t, 256> nibble = []() {
+      std::array<int8_t, 256> t;
+      t.fill(-1);
+      for (int i = 0; i < 10; ++i) t['0' + i] = static_cast<int8_t>(i);
+      for (int i = 0; i < 6; ++i) {
+        t['a' + i] = static_cast<int8_t>(10 + i);
+        t['A' + i] = static_cast<int8_t>(10 + i);
+      }
+      return t;
+    }();
+
+    if (length % 2 != 0) return false;
+    out.resize(length / 2);
+    int bad = 0;
+    for (size_t i = 0; i < out.size(); ++i) {
+      int hi = nibble[text[2 * i]];
+      int lo = nibble[text[2 * i + 1]];
+      bad |= hi | lo;
+      out[i] = static_cast<unsigned char>((hi << 4) | (lo & 15));
+    }
+    return bad >= 0;
+  }
+
+  /**
+   * @brief Decrypts the lines of the final candidates (a second, short scan).
+   */
+  static void
+  fillPlaintexts(const unsigned char* data, size_t size, std::vector<XORLineCandidate>& candidates) {
+    if (candidates.empty()) return;
+    size_t line = 1;
+    size_t pos = 0;
+    size_t last = 0;
+    for (const auto& c : candidates) last = std::max(last, c.line);
+
+    std::vector<unsigned char> bytes;
+    while (pos < size && line <= last) {
+      const void* nl = std::memchr(data + pos, '\n', size - pos);
+      size_t lineEnd = nl ? static_cast<size_t>(static_cast<const unsigned char*>(nl) - data) : size;
+      size_t next = lineEnd + 1;
+      if (lineEnd > pos && data[lineEnd - 1] == '\r') --lineEnd;
+
+      for (auto& c : candidates) {
+        if (c.line != line || !decodeHex(data + pos, lineEnd - pos, bytes)) continue;
+        c.plaintext.resize(bytes.size());
+        for (size_t i = 0; i < bytes.size(); ++i) {
+          c.plaintext[i] = static_cast<char>(bytes[i] ^ c.key);
+        }
+      }
+      pos = next;
+      ++line;
+    }
+  }
+
+  unsigned int m_threads;  ///< Worker threads (0 = all cores).
+};
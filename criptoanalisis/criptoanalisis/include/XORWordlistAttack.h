@@ -0,0 +1,148 @@
+#pragma once
+#include "Prerequisites.h"
+#include "MappedFile.h"
+#include "Parallel.h"
+#include "CandidateScorer.h"
+
+/**
+ * @struct XORWordlistResult
+ * @brief Outcome of an XORWordlistAttack run.
+ */
+struct
+XORWordlistResult {
+  uint64_t valid = 0;            ///< Words whose decryption is valid text.
+  uint64_t tested = 0;           ///< Words tested.
+  bool cancelled = false;        ///< The run was stopped before the end of the list.
+  double seconds = 0.0;          ///< Wall-clock time.
+  double wordsPerSecond = 0.0;   ///< Average rate.
+};
+
+/**
+ * @class XORWordlistAttack
+ * @brief Dictionary attack on repeating-key XOR over wordlist files of any size.
+ *
+ * The wordlist (one word per line, LF or CRLF) is memory-mapped and cut in
+ * fixed-size chunks that the cores take with Parallel::forStealing. A chunk
+ * owns the words that start inside it, so no word is copied or split. Each
+ * word is used as the key straight from the mapping: the first prefixLength
+ * bytes of the ciphertext are scored first with CandidateScorer, which aborts
+ * at the first byte that is not text, and only survivors are checked in full.
+ * Valid words go to a callback on the worker that found them, so nothing is
+ * collected and ranking runs in parallel too.
+ */
+class
+XORWordlistAttack {
+public:
+  /// Progress callback: (words tested so far, current words/second).
+  using ProgressFn = std::function<void(uint64_t, double)>;
+  /// Valid key callback: (word bytes, length), called concurrently from the workers.
+  using KeyFn = std::function<void(const unsigned char*, size_t)>;
+
+  /**
+   * @brief Constructs the attack for one ciphertext.
+   * @param ciphertext The encrypted bytes.
+   * @param threads Worker threads (0 = all cores).
+   * @param prefixLength Bytes checked before the full decryption.
+   */
+  XORWordlistAttack(const std::vector<unsigned char>& ciphertext,
+                    unsigned int threads = 0,
+                    size_t prefixLength = 64)
+    : m_ciphertext(ciphertext), m_threads(threads), m_prefixLength(prefixLength) {}
+
+  ~XORWordlistAttack() = default;
+
+  /**
+   * @brief Tests every word of @p path as the key.
+   * @param path Wordlist file.
+   * @param onKey Receives every word whose decryption is valid text; must be thread-safe.
+   * @param progress Optional callback, invoked about once per second.
+   * @param cancel Optional flag; setting it stops the run at the next chunk.
+   * @return Statistics of the run.
+   * @throws std::runtime_error if the wordlist cannot be mapped.
+   */
+  XORWordlistResult
+  run(const std::string& path,
+      const KeyFn& onKey,
+      ProgressFn progress = nullptr,
+      const std::atomic<bool>* cancel = nullptr) const {
+    using Clock = std::chrono::steady_clock;
+    MappedFile file(path);
+    const unsigned char* data = file.data();
+    size_t size = file.size();
+
+    std::atomic<uint64_t> tested{ 0 };
+    std::atomic<uint64_t> valid{ 0 };
+    std::atomic<bool> cancelled{ false };
+    XORWordlistResult result;
+    auto start = Clock::now();
+
+    ProgressReporter reporter(tested, progress);
+
+    uint64_t chunks = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    Parallel::forStealing(chunks, m_threads, 1, [&](uint64_t begin, uint64_t end) {
+      for (uint64_t chunk = begin; chunk < end; ++chunk) {
+        if (cancel != nullptr && cancel->load()) {
+          cancelled = true;
+          return false;
+        }
+
+        size_t pos = static_cast<size_t>(chunk * CHUNK_SIZE);
+        size_t limit = std::min(size, pos + CHUNK_SIZE);
+        // The word that crosses into this chunk belongs to the previous one
+        if (pos > 0 && data[pos - 1] != '\n') {
+          const void* nl = std::memchr(data + pos, '\n', size - pos);
+          pos = nl ? static_cast<size_t>(static_cast<const unsigned char*>(nl) - data) + 1 : size;
+        }
+
+        uint64_t words = 0;
+        uint64_t found = 0;
+        while (pos < limit) {
+          const void* nl = std::memchr(data + pos, '\n', size - pos);
+          size_t wordEnd = nl ? static_cast<size_t>(static_cast<const unsigned char*>(nl) - data) : size;
+          size_t next = wordEnd + 1;
+          if (wordEnd > pos && data[wordEnd - 1] == '\r') --wordEnd;
+
+          if (wordEnd > pos) {
+            ++words;
+            if (matches(data + pos, wordEnd - pos)) {
+              ++found;
+              onKey(data + pos, wordEnd - pos);
+            }
+          }
+          pos = next;
+        }
+        tested += words;
+        valid += found;
+      }
+      return true;
+    });
+
+    reporter.stop();
+
+    result.tested = tested.load();
+    result.valid = valid.load();
+    result.cancelled = cancelled.load();
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.wordsPerSecond = result.seconds > 0 ? result.tested / result.seconds : 0.0;
+    return result;
+  }
+
+  /**
+   * @brief Whether @p key decrypts the whole ciphertext into valid text.
+   */
+  bool
+  matches(const unsigned char* key, size_t keySize) const {
+    size_t size = m_ciphertext.size();
+    size_t prefix = std::min(m_prefixLength, size);
+    const unsigned char* c = m_ciphertext.data();
+    return CandidateScorer::evaluateXOR(c, prefix, key, keySize).valid &&
+           CandidateScorer::evaluateXOR(c + prefix, size - prefix, key, keySize, prefix).valid;
+  }
+
+private:
+  static constexpr size_t CHUNK_SIZE = size_t(1) << 20;
+
+  std::vector<unsigned char> m_ciphertext; ///< Encrypted bytes.
+  unsigned int m_threads;                  ///< Worker threads (0 = all cores).
+  size_t m_prefixLength;                   ///< Bytes checked before the full decryption.
+};
@@ -1,5 +1,25 @@
 using namespace std;
 #include <iostream>
+#include "CaesarKernel.h"
+#include "CandidateScorer.h"
+#include "CandidateSink.h"
+#include "LetterFrequency.h"
+#include "NGramModel.h"
+
+/**
+ * @struct CaesarCrackResult
+ * @brief Shift recovered by CaesarEncryption::crack.
+ */
+struct
+CaesarCrackResult {
+  int shift = 0;                                  ///< Most likely shift (0-25).
+  double chiSquare = 0.0;                         ///< Chi-square of the decryption's letters.
+  double confidence = 0.0;                        ///< Posterior probability of the shift (0-1).
+  LetterFrequency::Language language = LetterFrequency::Language::English; ///< Best-fitting language.
+  uint64_t letters = 0;                           ///< Letters counted.
+  std::vector<ShiftScore> ranking;                ///< All 26 shifts, most likely first.
+  std::string plaintext;                          ///< Decryption with @c shift (crack only).
+};
 
 /**
  * @class CaesarEncryption
@@ -22,37 +42,18 @@ public:
   /**
    * @brief Encrypts a string using the Caesar cipher with the specified shift.
    * @param text The input string to encrypt.
-   * @param shift The number of positions to shift each character.
+   * @param shift The number of positions to shift each character (any integer).
    * @return The encrypted string.
    *
-   * Lowercase and uppercase letters are shifted within their respective ranges.
-   * Digits are shifted within '0'-'9'. Non-alphanumeric characters are left unchanged.
+   * Lowercase and uppercase letters are shifted within their respective ranges (mod 26).
+   * Digits are shifted within '0'-'9' (mod 10). Non-alphanumeric characters are left unchanged.
    */
   string 
   EncryptionCaesar(const string& text,
                    int shift) {
-    string result = ""; // Se inicializa la variable de la respuesta
-
-    for (int i = 0; i < text.size(); i++) {
-      char posActual = text[i]; // Se obtiene el caracter actual
-
-      if (posActual >= 'a' && posActual <= 'z') { // Se verifica si es minuscula
-        char newPos = ((posActual - 'a' + shift) % 26) + 'a';
-        result += newPos;
-      }
-      else if (posActual >= 'A' && posActual <= 'Z') { // Se verifica si es mayuscula
-        char newPos = ((posActual - 'A' + shift) % 26) + 'A';
-        result += newPos;
-      }
-      else if (posActual >= '0' && posActual <= '9') // Se verifica si es un numero
-      {
-        char newPos = ((posActual - '0' + shift) % 10) + '0';
-        result += newPos;
-      }
-      else {
-        result += posActual; // Si no esta en el alfabeto, lo dejamos igual
-      }
-    }
+    string result(text.size(), '\0');
+    CaesarKernel::apply(reinterpret_cast<const unsigned char*>(text.data()),
+                        reinterpret_cast<unsigned char*>(&result[0]), text.size(), shift);
     return result;
   }
 
@@ -67,54 +68,189 @@ public:
   string 
   decode(const string& text,
          int shift) {
-    cout << "===== TEXTO DESCIFRADO =====\n";
-    return EncryptionCaesar(text, 26 - (shift % 26)); // Para decodificar, se le resta el desplazamiento
+    return EncryptionCaesar(text, -shift);
+  }
+
+  /**
+   * @brief Encrypts @p text in place (no copy; suited to large files).
+   * @param text The string to encrypt; overwritten with the ciphertext.
+   * @param shift The number of positions to shift each character.
+   */
+  void
+  encodeInPlace(string& text, int shift) {
+    unsigned char* data = reinterpret_cast<unsigned char*>(&text[0]);
+    CaesarKernel::apply(data, data, text.size(), shift);
+  }
+
+  /**
+   * @brief Decrypts @p text in place.
+   * @param text The string to decrypt; overwritten with the plaintext.
+   * @param shift The number of positions the original text was shifted.
+   */
+  void
+  decodeInPlace(string& text, int shift) {
+    encodeInPlace(text, -shift);
+  }
+
+  /**
+   * @brief Lookup table that undoes EncryptionCaesar(text, shift) byte by byte.
+   * @param shift The shift used to encrypt (any integer).
+   * @return Plaintext byte of every ciphertext byte.
+   */
+  static array<unsigned char, 256>
+  decodeTable(int shift) {
+    return CaesarKernel::table(-shift);
+  }
+
+  /**
+   * @brief Tries all Caesar shifts and hands their decryptions to @p sink.
+   * @param ciphertext The encrypted string to attack.
+   * @param sink Receives shifts 1 to 25 (key = the shift as text) ranked by
+   *             CandidateScorer::textScore plus the letter-context gain of the
+   *             n-gram models (NGramModel::bestContextGain) per byte. A shift
+   *             only moves letters and digits, so no shift is rejected for the
+   *             other bytes of the text (accents, symbols).
+   */
+  void
+  bruteForceAttack(const string& ciphertext, CandidateSink& sink) {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(ciphertext.data());
+    sink.setAttack("caesar");
+
+    //Probamos todos los desplazamientos posibles (1 a 25)
+    for (int shift = 1; shift < 26; shift++) {
+      array<unsigned char, 256> table = decodeTable(shift);
+      sink.note();
+      double total = CandidateScorer::textScore(data, ciphertext.size(), table);
+      if (!ciphertext.empty()) {
+        total += NGramModel::bestContextGain(ciphertext.size(), [&]() {
+          return [&, i = size_t(0)]() mutable { return table[data[i++]]; };
+        }) / ciphertext.size();
+      }
+      if (sink.accepts(total)) sink.add({ to_string(shift), total, decode(ciphertext, shift) });
+    }
   }
 
   /**
    * @brief Attempts to decrypt the ciphertext by trying all possible Caesar cipher shifts.
    * @param ciphertext The encrypted string to attack.
    *
-   * Prints all possible decrypted strings for shifts from 1 to 25.
+   * Prints the decrypted strings for shifts from 1 to 25, most likely first.
    */
   void 
   bruteForceAttack(const string& ciphertext) {
     cout << "===== ATAQUE DE FUERZA BRUTA =====\n";
     cout << "POSIBLES DESCIFRAMIENTOS:\n";
 
-    //Probamos todos los desplazamientos posibles (1 a 25)
-    for (int shift = 1; shift < 26; shift++) {
-      string decrypted = decode(ciphertext, shift);
-      cout << "Desplazamiento " << shift << ": " << decrypted << "\n";
+    CandidateSink sink(25);
+    bruteForceAttack(ciphertext, sink);
+    for (const auto& c : sink.results()) {
+      cout << "Desplazamiento " << c.key << ": " << c.plaintext << "\n";
     }
   }
 
   /**
-   * @brief Evaluates the most probable Caesar cipher key using frequency analysis.
-   * @param text The encrypted string to analyze.
-   * @return The most likely key (shift value) based on the frequency of letters.
+   * @brief Ranks the 26 shifts of a letter histogram against English and Spanish.
+   * @param hist Letter counts of the ciphertext.
+   * @return The shift with the lowest chi-square in the language that fits best;
+   *         no plaintext.
+   */
+  static CaesarCrackResult
+  analyze(const LetterFrequency::Histogram& hist) {
+    CaesarCrackResult result;
+    for (uint64_t h : hist) result.letters += h;
+    for (auto language : { LetterFrequency::Language::English, LetterFrequency::Language::Spanish }) {
+      std::vector<ShiftScore> ranking = LetterFrequency::rankShifts(hist, language);
+      if (result.ranking.empty() || ranking[0].chiSquare < result.chiSquare) {
+        result.shift = ranking[0].shift;
+        result.chiSquare = ranking[0].chiSquare;
+        result.confidence = ranking[0].probability;
+        result.language = language;
+        result.ranking = std::move(ranking);
+      }
+    }
+    return result;
+  }
+
+  /**
+   * @brief Ranks the 26 shifts of @p text with the n-gram models.
+   * @param text The ciphertext.
+   * @return The shift whose decryption is most likely under NGramModel, in the
+   *         language that fits best, with the posterior of every shift; no plaintext.
    *
-   * Assumes that the most frequent letter in the ciphertext corresponds to 'e' in plaintext.
+   * Only the first SAMPLE letters are scored: letter sequences settle the
+   * shift long before, so the cost does not grow with the text. Texts
+   * without letters keep the histogram result of analyze().
    */
-  int 
-  evaluatePossibleKey(const string& text) {
-    int frequency[26] = { 0 }; // Inicializamos el arreglo de frecuencias
+  static CaesarCrackResult
+  analyzeText(const string& text) {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(text.data());
+    LetterFrequency::Histogram hist = LetterFrequency::histogram(data, text.size());
+    CaesarCrackResult result = analyze(hist);
+    std::vector<uint8_t> letters = NGramModel::letters(data, text.size(), SAMPLE);
+    if (letters.empty()) return result;
 
-    for (char c : text) {
-      if (isalpha(c)) { // Verificamos si es una letra
-        c = tolower(c); // Convertimos a minuscula
-        frequency[c - 'a']++; // Incrementamos la frecuencia
+    std::array<double, 26> best{};
+    double bestLikelihood = -std::numeric_limits<double>::infinity();
+    for (auto language : { LetterFrequency::Language::English, LetterFrequency::Language::Spanish }) {
+      std::array<double, 26> ll = NGramModel::get(language).shiftLogLikelihoods(letters.data(), letters.size());
+      double top = *std::max_element(ll.begin(), ll.end());
+      if (top > bestLikelihood) {
+        bestLikelihood = top;
+        best = ll;
+        result.language = language;
       }
     }
 
-    int indexMax = 0;
-    for (int i = 0; i < 26; i++) {
-      if (frequency[i] > frequency[indexMax]) { // Buscamos la letra con mayor frecuencia
-        indexMax = i;
-      }
+    // Posterior with a uniform prior: softmax of the log-likelihoods
+    double sum = 0.0;
+    result.ranking.assign(26, ShiftScore{});
+    for (int s = 0; s < 26; ++s) {
+      result.ranking[s].shift = s;
+      result.ranking[s].chiSquare = LetterFrequency::chiSquare(hist, s, result.language);
+      result.ranking[s].probability = std::exp(best[s] - bestLikelihood);
+      sum += result.ranking[s].probability;
     }
+    for (auto& r : result.ranking) r.probability /= sum;
+    std::stable_sort(result.ranking.begin(), result.ranking.end(), [](const ShiftScore& a, const ShiftScore& b) {
+      return a.probability > b.probability;
+    });
+    result.shift = result.ranking[0].shift;
+    result.chiSquare = result.ranking[0].chiSquare;
+    result.confidence = result.ranking[0].probability;
+    return result;
+  }
+
+  /**
+   * @brief Breaks a Caesar ciphertext by the letter sequences of its decryptions.
+   * @param ciphertext The encrypted string.
+   * @return The best shift, its confidence and the decryption.
+   *
+   * The 26 shifts are scored on a sample of the letters (see analyzeText());
+   * only the winner is decrypted. Digits are decrypted with the same shift,
+   * which assumes the key was between 0 and 25.
+   */
+  CaesarCrackResult
+  crack(const string& ciphertext) {
+    CaesarCrackResult result = analyzeText(ciphertext);
+    result.plaintext = decode(ciphertext, result.shift);
+    return result;
+  }
 
-    int key = (indexMax - ('e' - 'a') + 26) % 26;
-    return key; // Calculamos la clave
+  /**
+   * @brief Evaluates the most probable Caesar cipher key using frequency analysis.
+   * @param text The encrypted string to analyze.
+   * @return The most likely key (shift value) based on the frequency of letters.
+   *
+   * Scores the letter sequence of every decryption with the English and
+   * Spanish n-gram models (see analyzeText()), instead of assuming the most
+   * frequent letter is 'e'.
+   */
+  int 
+  evaluatePossibleKey(const string& text) {
+    return analyzeText(text).shift;
   }
+
+private:
+  /// Letters scored by analyzeText().
+  static constexpr size_t SAMPLE = size_t(1) << 14;
 };
\ No newline at end of file
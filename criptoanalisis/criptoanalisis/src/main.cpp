@@ -5,6 +5,19 @@
 #include "AsciiBinary.h"
 #include "Vigenere.h"
 #include "DES.h"
+#include "BitslicedDES.h"
+#include "DESFileCipher.h"
+#include "TripleDES.h"
+#include "DESKeySearch.h"
+#include "DoubleDES.h"
+#include "DESMeetInTheMiddle.h"
+#include "DESRainbowTable.h"
+#include "DESAnalysis.h"
+#include "XORCribDragger.h"
+#include "XORSingleByteDetector.h"
+#include "StreamingKeyEstimator.h"
+#include "NGramModel.h"
+#include "VigenereAnnealer.h"
 
 /**
  * Reads the entire contents of a file into a string.
@@ -34,22 +47,760 @@ void saveToFile(const std::string& filename, const std::string& data) {
   file.write(data.data(), static_cast<std::streamsize>(data.size()));
 }
 
+/// Set by Ctrl+C while a StopOnCtrlC is alive.
+static std::atomic<bool> g_stopRequested{ false };
+
+extern "C" void stopRequestedHandler(int) {
+  g_stopRequested = true;
+}
+
+/**
+ * Routes Ctrl+C to g_stopRequested while it is alive, so the long attacks
+ * (options 14, 21 and 23) stop cleanly and report instead of ending the program.
+ * The previous handler is restored on destruction, also when the attack throws.
+ */
+struct
+StopOnCtrlC {
+  StopOnCtrlC() {
+    g_stopRequested = false;
+    previous = std::signal(SIGINT, stopRequestedHandler);
+  }
+
+  ~StopOnCtrlC() {
+    std::signal(SIGINT, previous);
+  }
+
+  /// Flag to pass as the cancel argument of the attacks.
+  const std::atomic<bool>* flag() const {
+    return &g_stopRequested;
+  }
+
+  void (*previous)(int);  ///< Handler restored on destruction.
+};
+
+/**
+ * Microbenchmark of the DES backends.
+ * Measures the single-block latency of DES::encode (chained blocks, so every
+ * call depends on the previous one) and the throughput of the bitsliced engine.
+ * @param blocks Number of blocks to encrypt with each backend.
+ */
+void runDESBenchmark(size_t blocks = 1 << 20) {
+  using Clock = std::chrono::steady_clock;
+  std::bitset<64> keyBits = convertTextKeyToBitset64("benchmrk");
+
+  DES des(keyBits);
+  std::bitset<64> block(0x0123456789ABCDEFULL);
+  auto start = Clock::now();
+  for (size_t i = 0; i < blocks; ++i) {
+    block = des.encode(block);
+  }
+  double scalarNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / blocks;
+
+  BitslicedDESNative sliced(keyBits);
+  std::vector<uint64_t> batch(BitslicedDESNative::BLOCKS, block.to_ullong());
+  start = Clock::now();
+  for (size_t done = 0; done < blocks; done += batch.size()) {
+    sliced.encode(batch.data(), batch.data(), batch.size());
+  }
+  double slicedNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / blocks;
+
+  std::cout << "DES::encode (tablas SP): " << std::fixed << std::setprecision(1)
+    << scalarNs << " ns/bloque\n";
+  std::cout << "BitslicedDES<" << BitslicedDESNative::BLOCKS / 64 << "> ("
+    << BitslicedDESNative::BLOCKS << " bloques/llamada): " << slicedNs << " ns/bloque\n";
+
+  TripleDES tdes(keyBits, ~keyBits, keyBits);
+  start = Clock::now();
+  for (size_t done = 0; done < blocks; done += batch.size()) {
+    tdes.encode(batch.data(), batch.data(), batch.size());
+  }
+  double tripleNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / blocks;
+  std::cout << "TripleDES (48 rondas, por lotes): " << tripleNs << " ns/bloque\n";
+  std::cout << "(control: " << std::hex << (block.to_ullong() ^ batch[0]) << std::dec << ")\n" << std::defaultfloat;
+}
+
+/**
+ * Known-plaintext DES key search over a mask-described keyspace.
+ * Asks for a known 8-character plaintext block, its ciphertext (16 hex digits)
+ * and the mask, then searches on all cores printing the rate once per second.
+ */
+void runDESKeySearch() {
+  std::string plainText, cipherHex, maskText;
+  std::cout << "Bloque de texto plano conocido (8 caracteres): ";
+  std::getline(std::cin, plainText);
+  std::cout << "Bloque cifrado correspondiente (16 digitos hex): ";
+  std::getline(std::cin, cipherHex);
+  std::cout << "Mascara de la clave (?l ?u ?d ?s ?a, ej. ?l?l?l?l?l?l?d?d): ";
+  std::getline(std::cin, maskText);
+
+  DESKeyMask mask(maskText);
+  uint64_t plain = DES::loadBlock(reinterpret_cast<const unsigned char*>(plainText.data()),
+                                  std::min<size_t>(8, plainText.size()));
+  uint64_t cipher = std::stoull(cipherHex, nullptr, 16);
+
+  std::cout << "Espacio de claves: " << mask.size() << " candidatas\n";
+  DESKeySearch search(plain, cipher);
+  DESKeySearchResult result = search.run(mask, [](uint64_t tested, double rate) {
+    std::cout << "  " << tested << " claves probadas, " << static_cast<uint64_t>(rate) << " claves/s\n";
+  });
+
+  if (result.found) {
+    std::cout << "[\u2713] Clave encontrada: '" << result.key << "'\n";
+  }
+  else {
+    std::cout << "[x] Ninguna clave de la mascara produce ese bloque cifrado.\n";
+  }
+  std::cout << result.tested << " claves en " << result.seconds << " s ("
+    << static_cast<uint64_t>(result.keysPerSecond) << " claves/s)\n";
+}
+
 /**
- * Converts a text key (up to 8 characters) to a 64-bit bitset.
- * Pads with zeros if the key is shorter than 8 characters.
- * @param input The text key to convert.
- * @return std::bitset<64> representing the key.
+ * Meet-in-the-middle attack on double DES.
+ * Asks for a known plaintext block and its 2DES ciphertext (or a 2DES key to
+ * produce it), then the masks of k1 and k2, and prints every key pair found.
  */
-std::bitset<64> convertTextKeyToBitset64(const std::string& input) {
-  std::bitset<64> bits(0);
-  int len = std::min(8, static_cast<int>(input.size()));
-  for (int i = 0; i < len; ++i) {
-    uint8_t c = static_cast<uint8_t>(input[i]);
-    bits <<= 8;
-    bits |= std::bitset<64>(c);
+void runDESMeetInTheMiddle() {
+  std::string plainText, cipherHex, firstMask, secondMask;
+  std::cout << "Bloque de texto plano conocido (8 caracteres): ";
+  std::getline(std::cin, plainText);
+  uint64_t plain = DES::loadBlock(reinterpret_cast<const unsigned char*>(plainText.data()),
+                                  std::min<size_t>(8, plainText.size()));
+
+  std::cout << "Bloque cifrado con 2DES (16 digitos hex, vacio = cifrarlo ahora): ";
+  std::getline(std::cin, cipherHex);
+  uint64_t cipher = 0;
+  if (cipherHex.empty()) {
+    std::string userKey;
+    std::cout << "Clave 2DES (hasta 16 caracteres): ";
+    std::getline(std::cin, userKey);
+    cipher = DoubleDES::fromText(userKey).encodeBlock(plain);
+    std::cout << "Bloque cifrado: " << std::hex << std::setw(16) << std::setfill('0') << cipher
+      << std::dec << std::setfill(' ') << "\n";
+  }
+  else {
+    cipher = std::stoull(cipherHex, nullptr, 16);
+  }
+
+  std::cout << "Mascara de k1 (?l ?u ?d ?s ?a): ";
+  std::getline(std::cin, firstMask);
+  std::cout << "Mascara de k2 (?l ?u ?d ?s ?a): ";
+  std::getline(std::cin, secondMask);
+
+  DESMeetInTheMiddle attack(plain, cipher);
+  DESMeetInTheMiddleResult result = attack.run(DESKeyMask(firstMask), DESKeyMask(secondMask));
+
+  for (const auto& keys : result.keys) {
+    std::cout << "[\u2713] k1 = '" << keys.first << "', k2 = '" << keys.second << "'\n";
+  }
+  if (result.keys.empty()) {
+    std::cout << "[x] Ningun par de claves de las mascaras produce ese bloque cifrado.\n";
+  }
+  std::cout << result.forwardKeys << " + " << result.backwardKeys << " operaciones DES en "
+    << result.seconds << " s (tabla de " << result.tableBytes / 1024 << " KB"
+    << (result.spilled ? ", volcada a disco" : "") << ", " << result.falsePositives
+    << " falsos positivos)\n";
+}
+
+/**
+ * Rainbow tables for text-derived DES keys.
+ * Either generates a table for a mask and a chosen plaintext, or looks up the
+ * key of a ciphertext block in an existing table file.
+ */
+void runDESRainbow() {
+  using Clock = std::chrono::steady_clock;
+  std::string operacion, tablePath;
+  std::cout << "Operacion (g = generar tabla, b = buscar clave): ";
+  std::getline(std::cin, operacion);
+  std::cout << "Archivo de la tabla: ";
+  std::getline(std::cin, tablePath);
+
+  if (operacion == "g") {
+    std::string maskText, plainText, lengthText, countText;
+    std::cout << "Mascara de las claves (?l ?u ?d ?s ?a): ";
+    std::getline(std::cin, maskText);
+    std::cout << "Bloque de texto plano elegido (8 caracteres): ";
+    std::getline(std::cin, plainText);
+    std::cout << "Longitud de cada cadena: ";
+    std::getline(std::cin, lengthText);
+    std::cout << "Numero de cadenas: ";
+    std::getline(std::cin, countText);
+
+    uint64_t plain = DES::loadBlock(reinterpret_cast<const unsigned char*>(plainText.data()),
+                                    std::min<size_t>(8, plainText.size()));
+    auto start = Clock::now();
+    uint64_t written = DESRainbowTable::generate(tablePath, DESKeyMask(maskText), plain,
+                                                 std::stoull(countText),
+                                                 static_cast<uint32_t>(std::stoul(lengthText)));
+    std::cout << "[\u2713] Tabla generada: " << written << " cadenas en "
+      << std::chrono::duration<double>(Clock::now() - start).count() << " s\n";
+    return;
+  }
+
+  DESRainbowTable table(tablePath);
+  std::cout << "Tabla de " << table.chainCount() << " cadenas de " << table.chainLength()
+    << " claves sobre " << table.mask().size() << " candidatas\n";
+
+  std::string cipherHex;
+  std::cout << "Bloque cifrado (16 digitos hex, vacio = cifrarlo ahora): ";
+  std::getline(std::cin, cipherHex);
+  uint64_t cipher = 0;
+  if (cipherHex.empty()) {
+    std::string userKey;
+    std::cout << "Clave (hasta 8 caracteres): ";
+    std::getline(std::cin, userKey);
+    cipher = DES(convertTextKeyToBitset64(userKey)).encodeBlock(table.plaintext());
+  }
+  else {
+    cipher = std::stoull(cipherHex, nullptr, 16);
+  }
+
+  DESKeySearchResult result = table.lookup(cipher);
+  if (result.found) {
+    std::cout << "[\u2713] Clave encontrada: '" << result.key << "'\n";
+  }
+  else {
+    std::cout << "[x] La clave no est\u00e1 cubierta por la tabla.\n";
+  }
+  std::cout << result.tested << " cifrados DES en " << result.seconds << " s\n";
+}
+
+/**
+ * Differential and linear analysis of the DES S-box and reduced-round DES.
+ * Prints the strongest DDT and LAT entries, then counts how often an input
+ * difference gives an output difference over 2^n chosen plaintext pairs.
+ */
+void runDESAnalysis() {
+  std::cout << "Mejores diferenciales de la S-Box (dx -> dy: cuenta/64):\n";
+  for (const auto& e : SBoxAnalysis::bestDifferentials(5)) {
+    std::cout << "  " << std::hex << std::setw(2) << std::setfill('0') << e.input << " -> " << e.output
+      << std::dec << std::setfill(' ') << ": " << e.value << "\n";
+  }
+  std::cout << "Mejores aproximaciones lineales (a . x = b . S(x): sesgo/64):\n";
+  for (const auto& e : SBoxAnalysis::bestApproximations(5)) {
+    std::cout << "  " << std::hex << std::setw(2) << std::setfill('0') << e.input << " . " << e.output
+      << std::dec << std::setfill(' ') << ": " << e.value << "\n";
+  }
+
+  std::string roundsText, inputText, outputText, maskText, pairsText, userKey;
+  std::cout << "Rondas (1-16): ";
+  std::getline(std::cin, roundsText);
+  std::cout << "Diferencia de entrada (16 digitos hex): ";
+  std::getline(std::cin, inputText);
+  std::cout << "Diferencia de salida esperada (16 digitos hex): ";
+  std::getline(std::cin, outputText);
+  std::cout << "Mascara de bits comparados (hex, vacio = todos): ";
+  std::getline(std::cin, maskText);
+  std::cout << "Pares (log2, vacio = 20): ";
+  std::getline(std::cin, pairsText);
+  std::cout << "Clave (hasta 8 caracteres): ";
+  std::getline(std::cin, userKey);
+
+  uint64_t mask = maskText.empty() ? ~0ULL : std::stoull(maskText, nullptr, 16);
+  int pairsLog = pairsText.empty() ? 20 : std::stoi(pairsText);
+  DESDifferentialExperiment experiment(convertTextKeyToBitset64(userKey));
+  DESDifferentialResult result = experiment.run(std::stoi(roundsText),
+                                                std::stoull(inputText, nullptr, 16),
+                                                std::stoull(outputText, nullptr, 16),
+                                                mask, 1ULL << std::min(pairsLog, 40));
+
+  std::cout << result.matches << " de " << result.pairs << " pares (p = " << result.probability
+    << ") en " << result.seconds << " s, " << static_cast<uint64_t>(result.pairsPerSecond) << " pares/s\n";
+}
+
+/**
+ * Reads an XOR ciphertext: the hex output of option 1 is decoded, any other
+ * file (e.g. the raw output of option 3) is taken as is.
+ */
+std::vector<unsigned char> readCipherBytes(const std::string& path, CryptoGenerator& gen) {
+  std::string content = readFromFile(path);
+  std::string trimmed = content;
+  while (!trimmed.empty() && std::isspace(static_cast<unsigned char>(trimmed.back()))) trimmed.pop_back();
+  bool isHex = !trimmed.empty() && trimmed.size() % 2 == 0 &&
+    std::all_of(trimmed.begin(), trimmed.end(), [](unsigned char c) { return std::isxdigit(c) != 0; });
+
+  if (isHex) {
+    std::vector<uint8_t> bytes = gen.fromHex(trimmed);
+    return std::vector<unsigned char>(bytes.begin(), bytes.end());
+  }
+  return std::vector<unsigned char>(content.begin(), content.end());
+}
+
+/**
+ * Ciphertext-only attack on repeating-key XOR (menu option 13).
+ * Accepts the hex output of option 1 or a raw binary file (option 3).
+ */
+void runXORBreak(CryptoGenerator& gen, XOREncoder& xorEnc) {
+  std::string path, maxText;
+  std::cout << "Archivo cifrado (hex de la opcion 1 o binario): ";
+  std::getline(std::cin, path);
+  std::cout << "Longitud maxima de clave (vacio = 64): ";
+  std::getline(std::cin, maxText);
+
+  std::vector<unsigned char> data = readCipherBytes(path, gen);
+
+  size_t maxLength = maxText.empty() ? 64 : std::stoul(maxText);
+  auto start = std::chrono::steady_clock::now();
+  auto candidates = xorEnc.breakRepeatingKey(data, maxLength);
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << data.size() << " bytes analizados en " << seconds << " s\n";
+  for (const auto& c : candidates) {
+    std::string plain(data.begin(), data.end());
+    xorEnc.encodeInPlace(plain, c.key);
+    std::cout << "Longitud " << c.keyLength << " (IC " << c.lengthScore << ", puntuaci\u00f3n "
+      << c.textScore << "): clave hex " << gen.toHex(std::vector<uint8_t>(c.key.begin(), c.key.end())) << "\n";
+    std::cout << "  " << plain.substr(0, 80) << "\n";
+  }
+}
+
+/**
+ * Wordlist attack on XOR with a key (menu option 14).
+ * The ciphertext is the raw output of option 3; the wordlist is mapped, not read.
+ */
+void runXORWordlist(XOREncoder& xorEnc) {
+  std::string path, wordlist;
+  std::cout << "Archivo cifrado (binario de la opcion 3): ";
+  std::getline(std::cin, path);
+  std::cout << "Lista de palabras (una clave por linea): ";
+  std::getline(std::cin, wordlist);
+
+  std::string content = readFromFile(path);
+  std::cout << "(Ctrl+C detiene el ataque)\n";
+  StopOnCtrlC stop;
+  xorEnc.bruteForceByDictionary(std::vector<unsigned char>(content.begin(), content.end()), wordlist, stop.flag());
+}
+
+/**
+ * Brute-force XOR attacks with ranked results (menu option 15).
+ * Keeps the best K candidates and optionally writes every valid one to a
+ * JSONL or CSV file (by extension) in the background.
+ */
+void runXORBruteForce(XOREncoder& xorEnc) {
+  std::string path, tipo, topText, outPath;
+  std::cout << "Archivo cifrado (binario de la opcion 3): ";
+  std::getline(std::cin, path);
+  std::cout << "Ataque (1 = clave de 1 byte, 2 = clave de 2 bytes, 3 = diccionario): ";
+  std::getline(std::cin, tipo);
+  std::cout << "Candidatos a mostrar (vacio = 10): ";
+  std::getline(std::cin, topText);
+  std::cout << "Exportar todos los candidatos (.jsonl o .csv, vacio = no): ";
+  std::getline(std::cin, outPath);
+
+  std::string content = readFromFile(path);
+  std::vector<unsigned char> cifrado(content.begin(), content.end());
+  std::unique_ptr<CandidateWriter> writer;
+  if (!outPath.empty()) {
+    writer.reset(new CandidateWriter(outPath, CandidateWriter::formatOf(outPath)));
+  }
+  CandidateSink sink(topText.empty() ? 10 : std::stoul(topText), writer.get());
+
+  auto start = std::chrono::steady_clock::now();
+  if (tipo == "2") xorEnc.bruteForce_2Byte(cifrado, sink);
+  else if (tipo == "3") xorEnc.bruteForceByDictionary(cifrado, sink);
+  else xorEnc.bruteForce_1Byte(cifrado, sink);
+  if (writer) writer->close();
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  for (const auto& c : sink.results()) {
+    std::cout << "=============================\n";
+    std::cout << "Clave (hex): " << std::hex << std::setfill('0');
+    for (unsigned char b : c.key) std::cout << std::setw(2) << static_cast<int>(b);
+    std::cout << std::dec << std::setfill(' ') << "  puntuaci\u00f3n " << c.score << "\n";
+    std::cout << "Texto posible : " << c.plaintext.substr(0, 120) << "\n";
+  }
+  std::cout << sink.valid() << " claves con texto v\u00e1lido en " << seconds << " s\n";
+}
+
+/**
+ * Crib dragging on XOR ciphertexts (menu option 16).
+ * Mode 1 recovers a repeating key from one file; mode 2 drags the cribs over
+ * every pair of files assumed to share the key stream (many-time pad).
+ */
+void runXORCribDrag(CryptoGenerator& gen) {
+  std::string modo, cribText, paths;
+  std::cout << "Modo (1 = clave repetida en un archivo, 2 = varios archivos con la misma clave): ";
+  std::getline(std::cin, modo);
+  std::cout << "Fragmentos conocidos (separados por |): ";
+  std::getline(std::cin, cribText);
+  std::cout << (modo == "2" ? "Carpeta o archivos separados por ;: " : "Archivo cifrado (hex de la opcion 1 o binario): ");
+  std::getline(std::cin, paths);
+
+  std::vector<std::string> cribs;
+  std::stringstream cribStream(cribText);
+  for (std::string crib; std::getline(cribStream, crib, '|');) {
+    if (!crib.empty()) cribs.push_back(crib);
+  }
+  if (cribs.empty()) throw std::runtime_error("Se necesita al menos un fragmento conocido.");
+
+  XORCribDragger dragger;
+  auto start = std::chrono::steady_clock::now();
+  if (modo != "2") {
+    std::vector<unsigned char> data = readCipherBytes(paths, gen);
+    auto keys = dragger.findKeys(data.data(), data.size(), cribs);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << data.size() << " bytes analizados en " << seconds << " s\n";
+    if (keys.empty()) {
+      std::cout << "[x] Ning\u00fan fragmento aparece con una clave peri\u00f3dica (el fragmento debe superar la clave en 3 bytes).\n";
+    }
+    for (size_t i = 0; i < keys.size() && i < 5; ++i) {
+      std::string plain(data.begin(), data.end());
+      XORKernel::apply(data.data(), reinterpret_cast<unsigned char*>(&plain[0]), data.size(),
+                       reinterpret_cast<const unsigned char*>(keys[i].key.data()), keys[i].key.size());
+      std::cout << (keys[i].valid ? "[\u2713] " : "[?] ") << "Clave de " << keys[i].key.size()
+        << " bytes (hex " << gen.toHex(std::vector<uint8_t>(keys[i].key.begin(), keys[i].key.end()))
+        << "), '" << keys[i].crib << "' en " << keys[i].offset << "\n";
+      std::cout << "  " << plain.substr(0, 80) << "\n";
+    }
+    return;
+  }
+
+  std::vector<std::string> files;
+  if (std::filesystem::is_directory(paths)) {
+    for (const auto& entry : std::filesystem::directory_iterator(paths)) {
+      if (entry.is_regular_file()) files.push_back(entry.path().string());
+    }
+    std::sort(files.begin(), files.end());
+  }
+  else {
+    std::stringstream pathStream(paths);
+    for (std::string path; std::getline(pathStream, path, ';');) {
+      if (!path.empty()) files.push_back(path);
+    }
+  }
+
+  std::vector<std::vector<unsigned char>> ciphertexts;
+  std::vector<std::string> names;
+  for (const auto& file : files) {
+    std::vector<unsigned char> data = readCipherBytes(file, gen);
+    if (data.empty()) continue;
+    ciphertexts.push_back(std::move(data));
+    names.push_back(std::filesystem::path(file).filename().string());
+  }
+  if (ciphertexts.size() < 2) throw std::runtime_error("Se necesitan al menos dos archivos no vac\u00edos.");
+
+  auto matches = dragger.dragPairs(ciphertexts, cribs);
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << ciphertexts.size() << " archivos, " << ciphertexts.size() * (ciphertexts.size() - 1) / 2
+    << " pares analizados en " << seconds << " s\n";
+  for (const auto& m : matches) {
+    std::cout << names[m.first] << " / " << names[m.second] << " @" << m.offset << ": '" << m.crib
+      << "' en uno => '" << m.fragment << "' en el otro (" << m.score << ")\n";
+  }
+}
+
+/**
+ * Detection of single-byte XOR among the lines of a hex file (menu option 17).
+ * The file is mapped, so it may be far larger than memory.
+ */
+void runXORDetectLines() {
+  std::string path, topText;
+  std::cout << "Archivo con un cifrado hex por linea: ";
+  std::getline(std::cin, path);
+  std::cout << "Candidatos a mostrar (vacio = 10): ";
+  std::getline(std::cin, topText);
+
+  MappedFile file(path);
+  auto start = std::chrono::steady_clock::now();
+  auto lines = XORSingleByteDetector().detect(file.data(), file.size(), topText.empty() ? 10 : std::stoul(topText));
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << file.size() << " bytes analizados en " << seconds << " s\n";
+  for (const auto& c : lines) {
+    std::cout << "L\u00ednea " << c.line << ": clave 0x" << std::hex << std::setw(2) << std::setfill('0')
+      << static_cast<int>(c.key) << std::dec << std::setfill(' ') << "  puntuaci\u00f3n " << c.score << "\n";
+    std::cout << "  " << c.plaintext.substr(0, 80) << "\n";
+  }
+}
+
+/**
+ * Ciphertext-only attack on Caesar (menu option 18).
+ * One letter histogram ranks the 26 shifts; only the winner is decrypted.
+ */
+void runCaesarCrack(CaesarEncryption& caesar) {
+  std::string path;
+  std::cout << "Archivo cifrado con Caesar: ";
+  std::getline(std::cin, path);
+
+  std::string content = readFromFile(path);
+  auto start = std::chrono::steady_clock::now();
+  CaesarCrackResult result = caesar.crack(content);
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << result.letters << " letras analizadas en " << seconds << " s\n";
+  std::cout << "Desplazamiento: " << result.shift << " (confianza " << result.confidence * 100.0
+    << " %, " << LetterFrequency::name(result.language) << ", chi-cuadrado " << result.chiSquare << ")\n";
+  for (size_t i = 1; i < result.ranking.size() && i < 4; ++i) {
+    std::cout << "  Alternativa " << result.ranking[i].shift << ": probabilidad " << result.ranking[i].probability * 100.0
+      << " %, chi-cuadrado " << result.ranking[i].chiSquare << "\n";
+  }
+  std::cout << "Texto descifrado: " << result.plaintext.substr(0, 200) << "\n";
+}
+
+/**
+ * Streaming key estimation for Caesar or Vigenere (menu option 19).
+ * Reads the file in chunks and stops once the key is known with the requested confidence.
+ */
+void runKeyEstimation() {
+  std::string tipo, path, maxText, thresholdText;
+  std::cout << "Cifrado (1 = Caesar, 2 = Vigenere): ";
+  std::getline(std::cin, tipo);
+  std::cout << "Archivo cifrado: ";
+  std::getline(std::cin, path);
+  if (tipo == "2") {
+    std::cout << "Longitud maxima de clave (vacio = 20): ";
+    std::getline(std::cin, maxText);
+  }
+  std::cout << "Confianza requerida (vacio = 0.999): ";
+  std::getline(std::cin, thresholdText);
+
+  size_t maxLength = tipo != "2" ? 1 : (maxText.empty() ? 20 : std::stoul(maxText));
+  StreamingKeyEstimator estimator(maxLength, thresholdText.empty() ? 0.999 : std::stod(thresholdText));
+  std::string lastKey;
+  auto start = std::chrono::steady_clock::now();
+  KeyEstimate e = estimator.runFile(path, [&](const KeyEstimate& current) {
+    if (current.key == lastKey) return;
+    lastKey = current.key;
+    std::cout << "  " << current.bytesRead << " bytes: clave " << current.key
+      << " (confianza " << current.confidence * 100.0 << " %)\n";
+  });
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  uint64_t total = std::filesystem::file_size(path);
+  if (tipo == "2") std::cout << "Clave: " << e.key;
+  else std::cout << "Desplazamiento: " << e.shifts[0];
+  std::cout << " (confianza " << e.confidence * 100.0 << " %, " << LetterFrequency::name(e.language) << ")\n";
+  std::cout << e.bytesRead << " de " << total << " bytes le\u00eddos en " << seconds << " s"
+    << (e.converged ? "" : "; no se alcanz\u00f3 la confianza requerida") << "\n";
+}
+
+/**
+ * Ciphertext-only attack on Vigenere (menu option 20).
+ * Key length by index of coincidence and Kasiski, key letters by chi-square per column.
+ */
+void runVigenereBreak() {
+  std::string path, maxText;
+  std::cout << "Archivo cifrado con Vigenere: ";
+  std::getline(std::cin, path);
+  std::cout << "Longitud maxima de clave (vacio = 120): ";
+  std::getline(std::cin, maxText);
+
+  std::string content = readFromFile(path);
+  auto start = std::chrono::steady_clock::now();
+  auto candidates = VigenereKeyBreaker(maxText.empty() ? 120 : std::stoul(maxText)).breakKey(content);
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << content.size() << " bytes analizados en " << seconds << " s\n";
+  if (candidates.empty()) throw std::runtime_error("El texto no contiene letras.");
+  for (const auto& c : candidates) {
+    std::cout << "Longitud " << c.keyLength << " (IC " << c.coincidence << ", Kasiski " << c.kasiski
+      << ", chi-cuadrado " << c.chiSquare << ", " << LetterFrequency::name(c.language) << "): " << c.key << "\n";
+  }
+  std::cout << "Texto descifrado: " << Vigenere(candidates[0].key).decode(content).substr(0, 200) << "\n";
+}
+
+/**
+ * Stochastic Vigenere attack for long keys and short texts (menu option 23).
+ * Runs VigenereAnnealer for the given key length, or for the three lengths
+ * proposed by VigenereKeyBreaker, and prints the most likely key with the
+ * progress of its run.
+ */
+void runVigenereAnneal() {
+  // Without letter context the n-gram score is only the letter frequencies,
+  // which column statistics (option 20) already fit exactly
+  if (NGramModel::get(LetterFrequency::Language::English).trainingLetters() == 0 &&
+      NGramModel::get(LetterFrequency::Language::Spanish).trainingLetters() == 0) {
+    std::cout << "[x] No hay ning\u00fan modelo de n-gramas entrenado; entr\u00e9nalo con la opci\u00f3n 22 "
+      "(sin \u00e9l el recocido solo ajusta las frecuencias de cada columna, como la opci\u00f3n 20).\n";
+    return;
+  }
+
+  std::string path, lengthText, restartsText, sweepsText;
+  std::cout << "Archivo cifrado con Vigenere: ";
+  std::getline(std::cin, path);
+  std::cout << "Longitud de la clave (vacio = estimar): ";
+  std::getline(std::cin, lengthText);
+  std::cout << "Reinicios (vacio = 4 por nucleo): ";
+  std::getline(std::cin, restartsText);
+  std::cout << "Barridos por reinicio (vacio = 100): ";
+  std::getline(std::cin, sweepsText);
+
+  std::string content = readFromFile(path);
+  std::vector<size_t> lengths;
+  if (!lengthText.empty()) {
+    lengths.push_back(std::stoul(lengthText));
+  }
+  else {
+    for (const auto& c : VigenereKeyBreaker().breakKey(content)) lengths.push_back(c.keyLength);
+  }
+  if (lengths.empty()) throw std::runtime_error("El texto no contiene letras.");
+
+  VigenereAnnealer annealer(restartsText.empty() ? 0 : std::stoul(restartsText),
+                            sweepsText.empty() ? 100 : std::stoul(sweepsText));
+  VigenereAnnealResult best;
+  double bestScore = -std::numeric_limits<double>::infinity();
+  std::cout << "(Ctrl+C detiene la b\u00fasqueda y muestra la mejor clave hasta ese momento)\n";
+  StopOnCtrlC stop;
+  for (size_t length : lengths) {
+    if (stop.flag()->load()) break;
+    VigenereAnnealResult result = annealer.solve(content, length, stop.flag());
+    std::cout << "Longitud " << length << ": " << result.key << " (log-verosimilitud " << result.logLikelihood
+      << ", " << LetterFrequency::name(result.language) << ", " << result.restartScores.size() << " reinicios, "
+      << result.proposals << " cambios en " << result.seconds << " s)\n";
+    // Each key letter costs log(26): longer keys must explain the text better
+    double score = result.logLikelihood - length * std::log(26.0);
+    if (score > bestScore) {
+      bestScore = score;
+      best = std::move(result);
+    }
+  }
+
+  if (stop.flag()->load()) std::cout << "[x] B\u00fasqueda detenida.\n";
+  std::cout << "Clave: " << best.key << "\nProgreso (mejor log-verosimilitud por barrido):";
+  size_t step = std::max<size_t>(1, best.history.size() / 10);
+  for (size_t i = 0; i < best.history.size(); i += step) std::cout << " " << static_cast<int64_t>(best.history[i]);
+  std::cout << "\nTexto descifrado: " << Vigenere(best.key).decode(content).substr(0, 200) << "\n";
+}
+
+/**
+ * Trains an n-gram language model from a corpus (menu option 22).
+ * The model is saved in the binary format of NGramModel and used at once by
+ * the Caesar, Vigenere and XOR attacks; saved in its default path, it is
+ * also loaded the next time the program starts.
+ */
+void runNGramTraining() {
+  std::string idioma, corpus, outPath;
+  std::cout << "Idioma del corpus (1 = ingles, 2 = espanol): ";
+  std::getline(std::cin, idioma);
+  std::cout << "Archivos o carpetas del corpus (separados por ;): ";
+  std::getline(std::cin, corpus);
+
+  LetterFrequency::Language language = idioma == "1" ? LetterFrequency::Language::English
+                                                     : LetterFrequency::Language::Spanish;
+  std::cout << "Archivo de salida (vacio = " << NGramModel::defaultPath(language) << "): ";
+  std::getline(std::cin, outPath);
+  if (outPath.empty()) outPath = NGramModel::defaultPath(language);
+
+  std::vector<std::string> paths;
+  std::stringstream corpusStream(corpus);
+  for (std::string path; std::getline(corpusStream, path, ';');) {
+    if (!path.empty()) paths.push_back(path);
+  }
+  if (paths.empty()) throw std::runtime_error("Se necesita al menos un archivo de corpus.");
+
+  auto start = std::chrono::steady_clock::now();
+  NGramModel model = NGramModel::train(language, paths);
+  uint64_t letters = model.trainingLetters();
+  // The installed model may be a mapping of outPath: the new file is written
+  // beside it and renamed into place once the new model has replaced it
+  std::string tmpPath = outPath + ".tmp";
+  model.save(tmpPath);
+  NGramModel::install(std::move(model));
+  std::filesystem::rename(tmpPath, outPath);
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "[\u2713] Modelo de " << LetterFrequency::name(language) << " entrenado con "
+    << letters << " letras en " << seconds << " s y guardado en " << outPath << "\n";
+}
+
+/**
+ * Exhaustive Vigenere key search (menu option 21).
+ * Tries every key up to the given length on all cores, optionally pruning
+ * key prefixes with poor letter statistics; with a checkpoint file, Ctrl+C
+ * saves the progress and running the option again resumes it.
+ */
+void runVigenereSearch() {
+  std::string path, maxText, marginText, checkpoint, wordsPath;
+  std::cout << "Archivo cifrado con Vigenere: ";
+  std::getline(std::cin, path);
+  std::cout << "Longitud maxima de clave (1-" << VigenereKeySearch::MAX_KEY_LENGTH << ", vacio = 4): ";
+  std::getline(std::cin, maxText);
+  std::cout << "Margen de poda por letra (ej. 0.5, vacio = sin poda): ";
+  std::getline(std::cin, marginText);
+  std::cout << "Archivo de punto de control (vacio = ninguno): ";
+  std::getline(std::cin, checkpoint);
+  std::cout << "Lista de palabras para puntuar (vacio = palabras comunes): ";
+  std::getline(std::cin, wordsPath);
+
+  std::string content = readFromFile(path);
+  if (!wordsPath.empty()) Vigenere::loadFitnessWords(wordsPath);
+  VigenereKeySearch search(content, Vigenere::fitnessScorer(), maxText.empty() ? 4 : std::stoul(maxText),
+                           marginText.empty() ? std::numeric_limits<double>::infinity() : std::stod(marginText));
+  if (!checkpoint.empty() && std::filesystem::exists(checkpoint)) {
+    std::cout << "Reanudando desde " << checkpoint << "\n";
+  }
+  std::cout << "Espacio de claves: " << search.totalKeys() << " claves (Ctrl+C detiene"
+    << (checkpoint.empty() ? "" : " y guarda el progreso") << ")\n";
+
+  CandidateSink sink(10);
+  VigenereSearchResult result;
+  {
+    StopOnCtrlC stop;
+    result = search.run(sink, checkpoint, [](uint64_t done, uint64_t total, double rate) {
+      std::cout << "  " << done << "/" << total << " claves, " << static_cast<uint64_t>(rate) << " claves/s\n";
+    }, stop.flag());
+  }
+
+  for (const auto& c : sink.results()) {
+    std::cout << "=============================\n";
+    std::cout << "Clave: " << c.key << "  puntuaci\u00f3n " << c.score << "\n";
+    std::cout << "Texto posible : " << c.plaintext.substr(0, 120) << "\n";
+  }
+  std::cout << result.tested << " claves probadas y " << result.pruned << " descartadas por poda de "
+    << result.total << " en " << result.seconds << " s (" << static_cast<uint64_t>(result.keysPerSecond) << " claves/s)\n";
+  if (result.cancelled) {
+    std::cout << "[x] B\u00fasqueda detenida" << (checkpoint.empty() ? ".\n" : "; progreso guardado en " + checkpoint + ".\n");
+  }
+}
+
+/**
+ * File encryption/decryption for options 6 (DES) and 9 (3DES).
+ * Asks for the block mode and the operation, streams the file through
+ * BlockFileCipher and optionally verifies the result.
+ * @param cipher The keyed primitive (DESBatch or TripleDES).
+ * @param name Algorithm name shown in the messages.
+ */
+template<typename Cipher>
+void runBlockFileCipher(const Cipher& cipher, const std::string& name,
+                        const std::string& pathIn, const std::string& pathOut,
+                        CryptoGenerator& gen) {
+  std::string modo;
+  std::cout << "Modo (1 = ECB, 2 = CTR, 3 = CBC, 4 = OFB): ";
+  std::getline(std::cin, modo);
+  DESMode mode = DESMode::ECB;
+  if (modo == "2") mode = DESMode::CTR;
+  else if (modo == "3") mode = DESMode::CBC;
+  else if (modo == "4") mode = DESMode::OFB;
+
+  std::string operacion;
+  std::cout << "Operacion (c = cifrar, d = descifrar): ";
+  std::getline(std::cin, operacion);
+
+  // Chunked, multithreaded encryption; the file is never loaded whole
+  BlockFileCipher<Cipher> fileCipher(cipher, mode);
+  if (operacion == "d") {
+    fileCipher.decryptFile(pathIn, pathOut);
+    std::cout << "[\u2713] Descifrado " << name << " completado.\n";
+    return;
+  }
+
+  uint64_t iv = 0;
+  if (mode != DESMode::ECB) {
+    iv = DES::loadBlock(gen.generateIV(8).data());
+  }
+  fileCipher.encryptFile(pathIn, pathOut, iv);
+  std::cout << "[\u2713] Cifrado " << name << " completado.\n";
+
+  // Optional verification: streams the output back through the decryptor
+  std::string verificar;
+  std::cout << "Verificar descifrando el resultado? (s/n): ";
+  std::getline(std::cin, verificar);
+  if (verificar == "s") {
+    if (fileCipher.verifyFile(pathIn, pathOut)) {
+      std::cout << "[\u2713] Verificaci\u00f3n: El contenido descifrado coincide con el original.\n";
+    }
+    else {
+      std::cout << "[x] Verificaci\u00f3n: El contenido descifrado NO coincide con el original.\n";
+    }
   }
-  bits <<= (8 - len) * 8;
-  return bits;
 }
 
 int main() {
@@ -62,12 +813,76 @@ int main() {
     // Main menu loop
     while (true) {
       std::cout << "\n==== Menu Principal ====" << std::endl;
-      std::cout << "1. Cifrado XOR (irrecuperable)\n2. Caesar\n3. XOR con clave\n4. Ascii-Binario\n5. Vigenere\n6. DES\n0. Salir\nOpcion: ";
+      std::cout << "1. Cifrado XOR (irrecuperable)\n2. Caesar\n3. XOR con clave\n4. Ascii-Binario\n5. Vigenere\n6. DES\n7. Benchmark DES\n8. Busqueda de clave DES\n9. 3DES (EDE)\n10. Ataque meet-in-the-middle 2DES\n11. Tablas rainbow DES\n12. Analisis diferencial/lineal DES\n13. Romper XOR de clave repetida\n14. Ataque de diccionario XOR\n15. Fuerza bruta XOR (ranking/exportar)\n16. Crib dragging XOR\n17. Detectar XOR de un byte (lineas hex)\n18. Romper Caesar (n-gramas)\n19. Estimar clave Caesar/Vigenere en flujo\n20. Romper Vigenere (Kasiski/IC)\n21. Busqueda exhaustiva Vigenere (reanudable)\n22. Entrenar modelo de n-gramas\n23. Romper Vigenere (recocido simulado)\n0. Salir\nOpcion: ";
       int opcion;
       std::cin >> opcion;
       std::cin.ignore();
 
       if (opcion == 0) break;
+      if (opcion == 7) {
+        runDESBenchmark();
+        continue;
+      }
+      if (opcion == 8) {
+        runDESKeySearch();
+        continue;
+      }
+      if (opcion == 10) {
+        runDESMeetInTheMiddle();
+        continue;
+      }
+      if (opcion == 11) {
+        runDESRainbow();
+        continue;
+      }
+      if (opcion == 12) {
+        runDESAnalysis();
+        continue;
+      }
+      if (opcion == 13) {
+        runXORBreak(gen, xorEnc);
+        continue;
+      }
+      if (opcion == 14) {
+        runXORWordlist(xorEnc);
+        continue;
+      }
+      if (opcion == 15) {
+        runXORBruteForce(xorEnc);
+        continue;
+      }
+      if (opcion == 16) {
+        runXORCribDrag(gen);
+        continue;
+      }
+      if (opcion == 17) {
+        runXORDetectLines();
+        continue;
+      }
+      if (opcion == 18) {
+        runCaesarCrack(caesar);
+        continue;
+      }
+      if (opcion == 19) {
+        runKeyEstimation();
+        continue;
+      }
+      if (opcion == 20) {
+        runVigenereBreak();
+        continue;
+      }
+      if (opcion == 21) {
+        runVigenereSearch();
+        continue;
+      }
+      if (opcion == 22) {
+        runNGramTraining();
+        continue;
+      }
+      if (opcion == 23) {
+        runVigenereAnneal();
+        continue;
+      }
 
       // Input and output file paths
       std::string pathIn, pathOut;
@@ -75,15 +890,16 @@ int main() {
       std::getline(std::cin, pathIn);
       std::cout << "Ruta del archivo de salida: ";
       std::getline(std::cin, pathOut);
-      std::string data = readFromFile(pathIn);
+      // DES (option 6) streams the file itself instead of loading it whole
+      std::string data = (opcion == 6 || opcion == 9) ? std::string() : readFromFile(pathIn);
       std::string result;
 
       switch (opcion) {
       case 1: {
         // XOR encryption with a random key (key is not saved, so decryption is impossible)
         std::string key = gen.generatePassword(16, true, true, true, false);
-        std::string cipher = xorEnc.encode(data, key);
-        std::vector<uint8_t> cipherBytes(cipher.begin(), cipher.end());
+        xorEnc.encodeInPlace(data, key);
+        std::vector<uint8_t> cipherBytes(data.begin(), data.end());
         std::string cipherHex = gen.toHex(cipherBytes);
         saveToFile(pathOut, cipherHex);
         std::cout << "\n[\u2713] Cifrado XOR irrecuperable completado.\n";
@@ -95,11 +911,12 @@ int main() {
         std::cout << "Desplazamiento: ";
         std::cin >> shift;
         std::cin.ignore();
-        std::string encrypted = caesar.EncryptionCaesar(data, shift);
-        saveToFile(pathOut, encrypted);
+        // In place: the file is encrypted, saved and decrypted back without extra copies
+        caesar.encodeInPlace(data, shift);
+        saveToFile(pathOut, data);
         std::cout << "[\u2713] Cifrado Caesar completado.\n";
-        std::string decrypted = caesar.decode(encrypted, shift);
-        std::cout << "Texto descifrado: " << decrypted << "\n";
+        caesar.decodeInPlace(data, shift);
+        std::cout << "Texto descifrado: " << data << "\n";
         break;
       }
       case 3: {
@@ -107,11 +924,12 @@ int main() {
         std::string key;
         std::cout << "Clave: ";
         std::getline(std::cin, key);
-        std::string encrypted = xorEnc.encode(data, key);
-        saveToFile(pathOut, encrypted);
+        // In place: the file is encrypted, saved and decrypted back without extra copies
+        xorEnc.encodeInPlace(data, key);
+        saveToFile(pathOut, data);
         std::cout << "[\u2713] Cifrado XOR con clave completado.\n";
-        std::string decrypted = xorEnc.encode(encrypted, key);
-        std::cout << "Texto descifrado: " << decrypted << "\n";
+        xorEnc.encodeInPlace(data, key);
+        std::cout << "Texto descifrado: " << data << "\n";
         break;
       }
       case 4: {
@@ -144,27 +962,17 @@ int main() {
 
         if (userKey.empty()) throw std::runtime_error("La clave no puede estar vac\u00eda.");
         std::bitset<64> keyBits = convertTextKeyToBitset64(userKey);
-        DES des(keyBits);
-
-        std::string output;
-        // Encrypt in 8-byte blocks, padding with nulls if needed
-        for (size_t i = 0; i < data.size(); i += 8) {
-          std::string block = data.substr(i, 8);
-          while (block.size() < 8) block += '\0'; // Padding
-          auto encoded = des.encode(des.stringToBitset64(block));
-          output += des.bitset64ToString(encoded);
-        }
-        saveToFile(pathOut, output);
-        std::cout << "[\u2713] Cifrado DES completado.\n";
-
-        // Immediate decryption for verification
-        std::string descifrado;
-        for (size_t i = 0; i < output.size(); i += 8) {
-          std::string block = output.substr(i, 8);
-          auto decoded = des.decode(des.stringToBitset64(block));
-          descifrado += des.bitset64ToString(decoded);
-        }
-        std::cout << "Texto descifrado: " << descifrado << "\n";
+
+        runBlockFileCipher(DESBatch(keyBits), "DES", pathIn, pathOut, gen);
+        break;
+      }
+      case 9: {
+        // Triple DES (EDE): same modes and streaming as option 6
+        std::string userKey;
+        std::cout << "Clave (hasta 24 caracteres; 8 = DES, 16 = 3DES de dos claves): ";
+        std::getline(std::cin, userKey);
+
+        runBlockFileCipher(TripleDES::fromText(userKey), "3DES", pathIn, pathOut, gen);
         break;
       }
       default: